@@ -0,0 +1,129 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../include/multi_replacer.hpp"
+#include "../include/parallel_replacer.hpp"
+#include "../include/replacer.hpp"
+#include "../include/replacer_kernel.hpp"
+#include "../include/stream_replacer.hpp"
+#include "../include/substring_replacer.hpp"
+
+namespace {
+
+// Arguments of every benchmark: text size, density of old_value in per mille, n
+const std::vector<int64_t> SIZES = benchmark::CreateRange(1 << 10, 1 << 30, 32);
+const std::vector<int64_t> DENSITIES = {1, 10, 100, 1000};
+const std::vector<int64_t> PERIODS = {1, 2, 7, 64};
+
+constexpr char OLD_VALUE = 'a';
+
+// Texts are expensive to build at 1 GB, so the last one is kept around
+std::string& text_for(size_t size, int64_t density) {
+    static std::pair<size_t, int64_t> key{0, -1};
+    static std::string text;
+    if (key != std::pair<size_t, int64_t>{size, density}) {
+        std::mt19937 gen(static_cast<unsigned>(size + density));
+        std::uniform_int_distribution<int> per_mille(0, 999);
+        text.assign(size, 'x');
+        for (char& c : text) {
+            if (per_mille(gen) < density) {
+                c = OLD_VALUE;
+            }
+        }
+        key = {size, density};
+    }
+    return text;
+}
+
+// Replacing OLD_VALUE with itself keeps the text the same between iterations
+// while doing exactly the same amount of work.
+template <typename Fn>
+void run(benchmark::State& state, Fn fn) {
+    std::string& text = text_for(state.range(0), state.range(1));
+    int n = static_cast<int>(state.range(2));
+    for (auto _ : state) {
+        fn(text, n);
+        benchmark::DoNotOptimize(text.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(text.size()));
+}
+
+void BM_ReplaceSymbolCopy(benchmark::State& state) {
+    run(state, [](std::string& text, int n) {
+        benchmark::DoNotOptimize(replace_symbol(text, n, OLD_VALUE, OLD_VALUE));
+    });
+}
+
+void BM_ReplaceSymbolInPlace(benchmark::State& state) {
+    run(state, [](std::string& text, int n) {
+        replace_symbol(std::span<char>(text), n, OLD_VALUE, OLD_VALUE);
+    });
+}
+
+void BM_Parallel(benchmark::State& state) {
+    run(state, [](std::string& text, int n) {
+        replace_symbol_parallel(std::span<char>(text), n, OLD_VALUE, OLD_VALUE);
+    });
+}
+
+void BM_Stream(benchmark::State& state) {
+    run(state, [](std::string& text, int n) {
+        StreamReplacer replacer(n, OLD_VALUE, OLD_VALUE);
+        for (size_t pos = 0; pos < text.size(); pos += 1 << 16) {
+            replacer.process(text.data() + pos, std::min<size_t>(1 << 16, text.size() - pos));
+        }
+    });
+}
+
+void BM_MultiRule(benchmark::State& state) {
+    run(state, [](std::string& text, int n) {
+        ReplaceRule rules[] = {{n, OLD_VALUE, OLD_VALUE}};
+        replace_symbols(std::span<char>(text), rules);
+    });
+}
+
+void BM_Substring(benchmark::State& state) {
+    run(state, [](std::string& text, int n) {
+        benchmark::DoNotOptimize(replace_substring(text, n, "xa", "xa"));
+    });
+}
+
+void add(benchmark::internal::Benchmark* bench) {
+    bench->ArgsProduct({SIZES, DENSITIES, PERIODS})->ArgNames({"size", "density", "n"});
+}
+
+}
+
+int main(int argc, char** argv) {
+    // scalar kernel is the baseline every other variant is compared to
+    for (ReplacerIsa isa : {ReplacerIsa::Scalar, ReplacerIsa::Sse2, ReplacerIsa::Avx2, ReplacerIsa::Avx512}) {
+        if (!isa_supported(isa)) {
+            continue;
+        }
+        std::string name = std::string("BM_Kernel/") + isa_name(isa);
+        add(benchmark::RegisterBenchmark(name.c_str(), [isa](benchmark::State& state) {
+            run(state, [isa](std::string& text, int n) {
+                replace_range(isa, text.data(), text.size(), n, OLD_VALUE, OLD_VALUE);
+            });
+        }));
+    }
+    add(benchmark::RegisterBenchmark("BM_ReplaceSymbolCopy", BM_ReplaceSymbolCopy));
+    add(benchmark::RegisterBenchmark("BM_ReplaceSymbolInPlace", BM_ReplaceSymbolInPlace));
+    add(benchmark::RegisterBenchmark("BM_Parallel", BM_Parallel)->UseRealTime());
+    add(benchmark::RegisterBenchmark("BM_Stream", BM_Stream));
+    add(benchmark::RegisterBenchmark("BM_MultiRule", BM_MultiRule));
+    add(benchmark::RegisterBenchmark("BM_Substring", BM_Substring));
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+}
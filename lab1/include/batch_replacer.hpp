@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdio>
+
+#include "replace_stats.hpp"
+
+enum class CounterMode {
+    // every record starts counting from zero
+    PerLine,
+    // a character's counter carries over from record to record, but only
+    // records whose rule replaces that character (with n > 0) add to it
+    Stream,
+};
+
+// Reads records of two lines - the text and the rule "n old new" - and writes
+// every replaced text as one output line. Returns false on malformed input or
+// an I/O error. stats, if given, gets one chunk per record.
+bool replace_batch(std::FILE* in, std::FILE* out, CounterMode mode, ReplaceStats* stats = nullptr);
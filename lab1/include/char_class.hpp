@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// Set of byte values (a 256-bit bitmap) to use as old_value in place of one character
+class CharClass {
+public:
+    constexpr CharClass() = default;
+
+    constexpr explicit CharClass(std::string_view chars) {
+        for (char c : chars) {
+            add(c);
+        }
+    }
+
+    constexpr CharClass& add(char c) {
+        auto u = static_cast<unsigned char>(c);
+        set[u / 64] |= uint64_t{1} << (u % 64);
+        return *this;
+    }
+
+    constexpr CharClass& add_range(char first, char last) {
+        for (int c = static_cast<unsigned char>(first); c <= static_cast<unsigned char>(last); ++c) {
+            add(static_cast<char>(c));
+        }
+        return *this;
+    }
+
+    constexpr bool contains(char c) const {
+        auto u = static_cast<unsigned char>(c);
+        return (set[u / 64] >> (u % 64)) & 1;
+    }
+
+    constexpr CharClass operator|(const CharClass& other) const {
+        CharClass result;
+        for (size_t i = 0; i < set.size(); ++i) {
+            result.set[i] = set[i] | other.set[i];
+        }
+        return result;
+    }
+
+    // ASCII classes, the same as the <cctype> functions in the "C" locale
+    static constexpr CharClass digits() {
+        return CharClass().add_range('0', '9');
+    }
+
+    static constexpr CharClass whitespace() {
+        return CharClass(" \t\n\v\f\r");
+    }
+
+    static constexpr CharClass lower() {
+        return CharClass().add_range('a', 'z');
+    }
+
+    static constexpr CharClass upper() {
+        return CharClass().add_range('A', 'Z');
+    }
+
+    static constexpr CharClass letters() {
+        return lower() | upper();
+    }
+
+    static constexpr CharClass punctuation() {
+        return CharClass().add_range('!', '/').add_range(':', '@').add_range('[', '`').add_range('{', '~');
+    }
+
+private:
+    std::array<uint64_t, 4> set{};
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// Line reader over large blocks: one fread per buffer instead of per-character
+// iostream calls. Lines are handed out as views into the internal buffer.
+class BufferedReader {
+public:
+    explicit BufferedReader(std::FILE* in, size_t buffer_size = 1 << 20);
+
+    // Next line without '\n'. The view stays valid until the next call and may
+    // be modified in place. Returns false at the end of input.
+    bool read_line(std::span<char>& line);
+
+    // Reads lines.size() lines at once, all of them stay valid until the next
+    // call. Returns false (and consumes nothing) if the input ends before.
+    bool read_lines(std::span<std::span<char>> lines);
+
+    // Everything has been read and handed out
+    bool exhausted() const;
+
+    bool failed() const;
+
+private:
+    std::FILE* in;
+    std::vector<char> buffer;
+    size_t begin;
+    size_t end;
+    bool eof;
+
+    void fill();
+};
+
+class BufferedWriter {
+public:
+    explicit BufferedWriter(std::FILE* out, size_t buffer_size = 1 << 20);
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    ~BufferedWriter();
+
+    void write(std::string_view data);
+
+    void put(char c);
+
+    // Returns false if any write failed
+    bool flush();
+
+private:
+    std::FILE* out;
+    std::vector<char> buffer;
+    size_t used;
+    bool ok;
+};
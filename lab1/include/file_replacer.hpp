@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+
+#include "replace_stats.hpp"
+
+// Rewrites the file in place through a shared memory mapping, without
+// copying its contents into userspace buffers. Returns false if the file
+// can not be opened or mapped.
+bool replace_symbol_in_file(const std::string& path, int n, char old_value, char new_value, ReplaceStats* stats = nullptr);
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+struct ReplaceRule {
+    int n;
+    char old_value;
+    char new_value;
+};
+
+// A rule set applied in one pass over the text. Every rule counts the
+// occurrences of its old_value in the original text (replacements made by
+// other rules are not seen). If several rules with the same old_value fire on
+// one character, the rule that comes first in the list wins; the counters of
+// the others still advance. Rules with n <= 0 are ignored.
+class MultiReplacer {
+public:
+    explicit MultiReplacer(std::span<const ReplaceRule> rules);
+
+    // Rewrites the chunk in place, counters are kept between calls
+    void process(char* data, size_t size);
+
+    void reset();
+
+private:
+    // Rules of one character occupy [first, last) in the arrays below
+    struct Slot {
+        uint32_t first;
+        uint32_t last;
+    };
+
+    std::array<Slot, 256> table;
+    std::vector<size_t> period;
+    std::vector<size_t> need;
+    std::vector<char> new_value;
+};
+
+std::string replace_symbols(std::string text, std::span<const ReplaceRule> rules);
+
+void replace_symbols(std::span<char> text, std::span<const ReplaceRule> rules);
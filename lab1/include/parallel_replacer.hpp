@@ -0,0 +1,17 @@
+#pragma once
+
+#include <span>
+#include <string>
+
+#include "replace_stats.hpp"
+
+// Multi-threaded replace_symbol for large buffers. The text is split into one
+// chunk per thread; every thread counts old_value in its chunk, then rewrites
+// it starting from the exclusive prefix sum of the counts before it, so the
+// result is identical to replace_symbol. threads == 0 means hardware_concurrency().
+// stats, if given, gets the whole call added as one chunk.
+std::string replace_symbol_parallel(std::string text, int n, char old_value, char new_value, unsigned threads = 0,
+                                    ReplaceStats* stats = nullptr);
+
+void replace_symbol_parallel(std::span<char> text, int n, char old_value, char new_value, unsigned threads = 0,
+                             ReplaceStats* stats = nullptr);
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+#include "replace_stats.hpp"
+
+// Where the time of replace_pipeline went. *_busy is time spent doing the
+// stage's own work, *_stall is time spent waiting for another stage.
+struct PipelineStats {
+    std::chrono::nanoseconds read_busy{0};
+    std::chrono::nanoseconds read_stall{0};
+    std::chrono::nanoseconds compute_busy{0};
+    std::chrono::nanoseconds compute_stall{0};
+    std::chrono::nanoseconds write_busy{0};
+    std::chrono::nanoseconds write_stall{0};
+    size_t bytes = 0;
+    size_t buffers = 0;
+};
+
+// Three-stage version of replace_stream: a reader thread fills buffers, the
+// calling thread replaces in them and a writer thread drains them, so I/O
+// overlaps with the replacement. buffer_count buffers of buffer_size bytes are
+// reused in a ring. replace_stats, if given, gets one chunk per buffer.
+// Returns false on an I/O error.
+bool replace_pipeline(std::FILE* in, std::FILE* out, int n, char old_value, char new_value,
+                      PipelineStats* stats = nullptr, size_t buffer_size = 1 << 20, size_t buffer_count = 4,
+                      ReplaceStats* replace_stats = nullptr);
+
+void print_stats(std::FILE* out, const PipelineStats& stats);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bitvector with rank and select directories. Rank takes a directory lookup
+// and at most 7 popcounts. Select starts from the block sampled for every
+// SELECT_SAMPLE-th one (zero), walks the block counters up to the wanted
+// block, scans at most 8 words and finishes with a broadword select. The
+// walk covers the blocks between two samples, a few of them as long as the
+// wanted bits are not sparse; OccurrenceIndex only keeps such bitvectors.
+class RankSelect {
+public:
+    static constexpr size_t SELECT_SAMPLE = 2048;
+
+    RankSelect() = default;
+
+    // Bit i is bit i % 64 of words[i / 64]; bits at size and above must be zero
+    RankSelect(std::vector<uint64_t> words, size_t size);
+
+    size_t size() const;
+
+    size_t ones() const;
+
+    bool get(size_t pos) const;
+
+    // Ones in [0, pos)
+    size_t rank1(size_t pos) const;
+
+    // Position of the one (zero) with 0-based index r, r < ones() (zeros)
+    size_t select1(size_t r) const;
+    size_t select0(size_t r) const;
+
+    // Bytes used by the bits and the directories
+    size_t memory_usage() const;
+
+private:
+    std::vector<uint64_t> bits;
+    // ones before every superblock, and before every block counted from the
+    // start of its superblock
+    std::vector<uint64_t> supers;
+    std::vector<uint16_t> blocks;
+    // block holding every SELECT_SAMPLE-th one and zero
+    std::vector<uint32_t> one_samples;
+    std::vector<uint32_t> zero_samples;
+    size_t length = 0;
+    size_t total = 0;
+
+    // ones before block b
+    size_t block_rank(size_t b) const;
+};
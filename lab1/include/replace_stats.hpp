@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Built with REPLACER_STATS=0 every recording call is empty and compiles away
+#ifndef REPLACER_STATS
+#define REPLACER_STATS 1
+#endif
+
+// Counters filled by replace_symbol and its streaming/batch variants when a
+// pointer to this object is passed. Values accumulate over calls.
+struct ReplaceStats {
+    uint64_t bytes_scanned = 0;
+    uint64_t matches = 0;
+    uint64_t replacements = 0;
+    uint64_t chunks = 0;
+    uint64_t nanoseconds = 0;
+
+    // One line: {"bytes_scanned":...,"matches":...,...}
+    std::string to_json() const;
+};
+
+inline bool stats_enabled(const ReplaceStats* stats) {
+    return REPLACER_STATS && stats != nullptr;
+}
+
+// Adds one processed chunk; time is measured from start to now
+inline void record_stats(ReplaceStats* stats, uint64_t bytes, uint64_t matches, uint64_t replacements,
+                         std::chrono::steady_clock::time_point start) {
+    if (!stats_enabled(stats)) {
+        return;
+    }
+    stats->bytes_scanned += bytes;
+    stats->matches += matches;
+    stats->replacements += replacements;
+    ++stats->chunks;
+    stats->nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
@@ -1,5 +1,55 @@
 #pragma once
 
+#include <span>
 #include <string>
 
-std::string replace_symbol(std::string text, int n, char old_value, char new_value);
\ No newline at end of file
+#include "char_class.hpp"
+#include "replace_stats.hpp"
+
+// stats, if given, gets the counters of the call added as one chunk, also for
+// n <= 0 (see replace_stats.hpp). The time covers the extra counting pass.
+std::string replace_symbol(std::string text, int n, char old_value, char new_value, ReplaceStats* stats = nullptr);
+
+// In-place versions: no copy of the text is made
+void replace_symbol(std::span<char> text, int n, char old_value, char new_value, ReplaceStats* stats = nullptr);
+
+void replace_symbol(char* first, char* last, int n, char old_value, char new_value, ReplaceStats* stats = nullptr);
+
+// Every n-th character that belongs to old_values, e.g. CharClass::digits()
+std::string replace_symbol(std::string text, int n, const CharClass& old_values, char new_value, ReplaceStats* stats = nullptr);
+
+void replace_symbol(std::span<char> text, int n, const CharClass& old_values, char new_value, ReplaceStats* stats = nullptr);
+
+// Compile-time rule. With N known the counter needs no modulo: N == 1 replaces
+// every match, power-of-two N uses a mask, other N count down to zero.
+template <int N, char Old, char New>
+constexpr void replace_symbol(std::span<char> text) {
+    if constexpr (N <= 0) {
+        return;
+    } else if constexpr (N == 1) {
+        for (char& c : text) {
+            c = c == Old ? New : c;
+        }
+    } else if constexpr ((N & (N - 1)) == 0) {
+        unsigned cnt = 0;
+        for (char& c : text) {
+            if (c == Old && (++cnt & (N - 1)) == 0) {
+                c = New;
+            }
+        }
+    } else {
+        int left = N;
+        for (char& c : text) {
+            if (c == Old && --left == 0) {
+                c = New;
+                left = N;
+            }
+        }
+    }
+}
+
+template <int N, char Old, char New>
+constexpr std::string replace_symbol(std::string text) {
+    replace_symbol<N, Old, New>(std::span<char>(text));
+    return text;
+}
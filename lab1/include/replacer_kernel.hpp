@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "char_class.hpp"
+
+// Instruction sets the replace kernel can be built for
+enum class ReplacerIsa {
+    Scalar,
+    Sse2,
+    Avx2,
+    Avx512,
+};
+
+// Best instruction set available on the running CPU (checked once via CPUID)
+ReplacerIsa detect_isa();
+
+bool isa_supported(ReplacerIsa isa);
+
+const char* isa_name(ReplacerIsa isa);
+
+// Replaces every n-th old_value in [data, data + size) in place.
+// count is the number of occurrences already seen (modulo n), so a text can be
+// fed in several pieces. Returns the updated count. n must be positive.
+size_t replace_range(char* data, size_t size, size_t n, char old_value, char new_value, size_t count = 0);
+
+// Same as above, but with an explicitly chosen kernel (isa must be supported)
+size_t replace_range(ReplacerIsa isa, char* data, size_t size, size_t n, char old_value, char new_value, size_t count = 0);
+
+// Number of old_value bytes in [data, data + size)
+size_t count_range(const char* data, size_t size, char old_value);
+
+size_t count_range(ReplacerIsa isa, const char* data, size_t size, char old_value);
+
+// Sets bit i % 64 of out[i / 64] when data[i] == value. out must hold
+// (size + 63) / 64 words; bits past size are zero.
+void match_bits(const char* data, size_t size, char value, uint64_t* out);
+
+void match_bits(ReplacerIsa isa, const char* data, size_t size, char value, uint64_t* out);
+
+// Position of the first occurrence of pattern in text at or after from,
+// std::string_view::npos if there is none. Candidates are filtered by the
+// first and the last byte of the pattern a block at a time.
+size_t find_substring(std::string_view text, std::string_view pattern, size_t from = 0);
+
+size_t find_substring(ReplacerIsa isa, std::string_view text, std::string_view pattern, size_t from = 0);
+
+// replace_range for a character class: one counter is shared by all members.
+// The SIMD kernels test membership with two 16-entry nibble tables (pshufb),
+// which needs SSSE3 for the Sse2 kernel.
+size_t replace_class_range(const CharClass& old_values, char* data, size_t size, size_t n, char new_value, size_t count = 0);
+
+size_t replace_class_range(ReplacerIsa isa, const CharClass& old_values, char* data, size_t size, size_t n, char new_value, size_t count = 0);
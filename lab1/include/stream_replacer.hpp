@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+#include "replace_stats.hpp"
+
+// Replaces every n-th old_value in a text that arrives in chunks of any size.
+// The occurrence counter is kept between chunks, so feeding a text piece by
+// piece gives the same result as replace_symbol on the whole text.
+class StreamReplacer {
+public:
+    // stats, if given, gets one chunk added per process() call
+    StreamReplacer(int n, char old_value, char new_value, ReplaceStats* stats = nullptr);
+
+    // Rewrites the chunk in place
+    void process(char* data, size_t size);
+
+    std::string process(std::string chunk);
+
+    // Forget occurrences seen so far (start of a new text)
+    void reset();
+
+    // Occurrences of old_value seen since the last replacement
+    size_t pending() const;
+
+private:
+    size_t n;
+    char old_value;
+    char new_value;
+    size_t count;
+    ReplaceStats* stats;
+};
+
+// Copies in to out through a single buffer of buffer_size bytes (at least 1), replacing on the way.
+// Memory use does not depend on the input size. Returns false on an I/O error.
+bool replace_stream(std::FILE* in, std::FILE* out, int n, char old_value, char new_value,
+                    size_t buffer_size = 1 << 16, ReplaceStats* stats = nullptr);
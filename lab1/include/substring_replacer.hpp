@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Replaces every n-th occurrence of old_value with new_value, which may be
+// longer or shorter. Occurrences are counted left to right and do not
+// overlap: after a match the search continues behind it. The output size is
+// computed by a counting pass first, so the result is allocated once.
+std::string replace_substring(std::string_view text, int n, std::string_view old_value, std::string_view new_value);
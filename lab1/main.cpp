@@ -1,8 +1,41 @@
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include "include/batch_replacer.hpp"
+#include "include/file_replacer.hpp"
+#include "include/pipeline.hpp"
 #include "include/replacer.hpp"
+#include "include/stream_replacer.hpp"
 
 
-int main(int argc, char** argv) {
+int run(int argc, char** argv, ReplaceStats* stats) {
+    // program --stream n old new: stdin -> stdout with constant memory
+    if (argc == 5 && std::strcmp(argv[1], "--stream") == 0) {
+        return replace_stream(stdin, stdout, std::atoi(argv[2]), argv[3][0], argv[4][0], 1 << 16, stats) ? 0 : 1;
+    }
+    // program --pipeline n old new: like --stream, but reading, replacing and
+    // writing run at the same time; time per stage is printed to stderr
+    if (argc == 5 && std::strcmp(argv[1], "--pipeline") == 0) {
+        PipelineStats pipeline_stats;
+        bool ok = replace_pipeline(stdin, stdout, std::atoi(argv[2]), argv[3][0], argv[4][0], &pipeline_stats, 1 << 20, 4, stats);
+        print_stats(stderr, pipeline_stats);
+        return ok ? 0 : 1;
+    }
+    // program --file path n old new: rewrite the file in place via mmap
+    if (argc == 6 && std::strcmp(argv[1], "--file") == 0) {
+        return replace_symbol_in_file(argv[2], std::atoi(argv[3]), argv[4][0], argv[5][0], stats) ? 0 : 1;
+    }
+
+    // program --batch [--running]: many records "text\nn old new\n" from stdin;
+    // with --running the counter is not reset between records
+    if ((argc == 2 || argc == 3) && std::strcmp(argv[1], "--batch") == 0) {
+        bool running = argc == 3 && std::strcmp(argv[2], "--running") == 0;
+        if (argc == 3 && !running) {
+            return 2;
+        }
+        return replace_batch(stdin, stdout, running ? CounterMode::Stream : CounterMode::PerLine, stats) ? 0 : 1;
+    }
+
     std::string text;
     int n;
     char old_value, new_value;
@@ -10,7 +43,20 @@ int main(int argc, char** argv) {
     std::getline(std::cin, text);
     std::cin >> n >> old_value >> new_value;
 
-    text = replace_symbol(text, n, old_value, new_value);
+    text = replace_symbol(text, n, old_value, new_value, stats);
 
     std::cout << text << "\n";
-}
\ No newline at end of file
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    // program --stats <mode...>: counters of the run as one JSON line on stderr
+    if (argc > 1 && std::strcmp(argv[1], "--stats") == 0) {
+        ReplaceStats stats;
+        argv[1] = argv[0];
+        int code = run(argc - 1, argv + 1, &stats);
+        std::cerr << stats.to_json() << "\n";
+        return code;
+    }
+    return run(argc, argv, nullptr);
+}
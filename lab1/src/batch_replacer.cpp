@@ -0,0 +1,79 @@
+#include "../include/batch_replacer.hpp"
+#include "../include/fast_io.hpp"
+#include "../include/replacer_kernel.hpp"
+
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+
+namespace {
+
+struct Rule {
+    int n;
+    char old_value;
+    char new_value;
+};
+
+// Same format std::cin >> n >> old_value >> new_value accepts
+bool parse_rule(std::span<char> line, Rule& rule) {
+    const char* pos = line.data();
+    const char* last = line.data() + line.size();
+    auto skip_spaces = [&]() {
+        while (pos != last && std::isspace(static_cast<unsigned char>(*pos))) {
+            ++pos;
+        }
+    };
+    skip_spaces();
+    auto [ptr, ec] = std::from_chars(pos, last, rule.n);
+    if (ec != std::errc()) {
+        return false;
+    }
+    pos = ptr;
+    for (char* value : {&rule.old_value, &rule.new_value}) {
+        skip_spaces();
+        if (pos == last) {
+            return false;
+        }
+        *value = *pos++;
+    }
+    return true;
+}
+
+}
+
+bool replace_batch(std::FILE* in, std::FILE* out, CounterMode mode, ReplaceStats* stats) {
+    BufferedReader reader(in);
+    BufferedWriter writer(out);
+    std::array<uint64_t, 256> seen{};
+
+    std::span<char> record[2];
+    while (reader.read_lines(record)) {
+        std::span<char> text = record[0];
+        Rule rule;
+        if (!parse_rule(record[1], rule)) {
+            return false;
+        }
+        // records with n <= 0 are copied as is, but still counted in stats
+        auto start = stats_enabled(stats) ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+        size_t matches = 0;
+        if ((rule.n > 0 && mode == CounterMode::Stream) || stats_enabled(stats)) {
+            matches = count_range(text.data(), text.size(), rule.old_value);
+        }
+        size_t replaced = 0;
+        if (rule.n > 0) {
+            size_t count = 0;
+            if (mode == CounterMode::Stream) {
+                uint64_t& total = seen[static_cast<unsigned char>(rule.old_value)];
+                count = total % rule.n;
+                total += matches;
+            }
+            replace_range(text.data(), text.size(), rule.n, rule.old_value, rule.new_value, count);
+            replaced = (count + matches) / rule.n;
+        }
+        record_stats(stats, text.size(), matches, replaced, start);
+        writer.write(std::string_view(text.data(), text.size()));
+        writer.put('\n');
+    }
+    return reader.exhausted() && !reader.failed() && writer.flush();
+}
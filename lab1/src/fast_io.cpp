@@ -0,0 +1,100 @@
+#include "../include/fast_io.hpp"
+
+#include <cstring>
+
+BufferedReader::BufferedReader(std::FILE* in, size_t buffer_size)
+    : in(in), buffer(buffer_size > 0 ? buffer_size : 1), begin(0), end(0), eof(false) {}
+
+void BufferedReader::fill() {
+    // keep the unfinished line and make room behind it
+    if (begin > 0) {
+        std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+        end -= begin;
+        begin = 0;
+    }
+    if (end == buffer.size()) {
+        buffer.resize(buffer.size() * 2);
+    }
+    size_t read = std::fread(buffer.data() + end, 1, buffer.size() - end, in);
+    end += read;
+    if (read == 0) {
+        eof = true;
+    }
+}
+
+bool BufferedReader::read_line(std::span<char>& line) {
+    return read_lines(std::span<std::span<char>>(&line, 1));
+}
+
+bool BufferedReader::read_lines(std::span<std::span<char>> lines) {
+    while (true) {
+        size_t pos = begin;
+        size_t found = 0;
+        for (; found < lines.size(); ++found) {
+            void* newline = std::memchr(buffer.data() + pos, '\n', end - pos);
+            if (newline == nullptr) {
+                break;
+            }
+            size_t stop = static_cast<char*>(newline) - buffer.data();
+            lines[found] = std::span<char>(buffer.data() + pos, stop - pos);
+            pos = stop + 1;
+        }
+        if (found == lines.size()) {
+            begin = pos;
+            return true;
+        }
+        if (eof) {
+            // the last line may have no '\n'
+            if (found + 1 == lines.size() && pos < end) {
+                lines[found] = std::span<char>(buffer.data() + pos, end - pos);
+                begin = end;
+                return true;
+            }
+            return false;
+        }
+        fill();
+    }
+}
+
+bool BufferedReader::exhausted() const {
+    return eof && begin == end;
+}
+
+bool BufferedReader::failed() const {
+    return std::ferror(in) != 0;
+}
+
+BufferedWriter::BufferedWriter(std::FILE* out, size_t buffer_size)
+    : out(out), buffer(buffer_size > 0 ? buffer_size : 1), used(0), ok(true) {}
+
+BufferedWriter::~BufferedWriter() {
+    flush();
+}
+
+void BufferedWriter::write(std::string_view data) {
+    if (used + data.size() > buffer.size()) {
+        flush();
+        if (data.size() >= buffer.size()) {
+            ok = ok && std::fwrite(data.data(), 1, data.size(), out) == data.size();
+            return;
+        }
+    }
+    std::memcpy(buffer.data() + used, data.data(), data.size());
+    used += data.size();
+}
+
+void BufferedWriter::put(char c) {
+    if (used == buffer.size()) {
+        flush();
+    }
+    buffer[used++] = c;
+}
+
+bool BufferedWriter::flush() {
+    if (used > 0) {
+        ok = ok && std::fwrite(buffer.data(), 1, used, out) == used;
+        used = 0;
+    }
+    ok = ok && std::fflush(out) == 0;
+    return ok;
+}
@@ -0,0 +1,49 @@
+#include "../include/file_replacer.hpp"
+#include "../include/replacer.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool replace_symbol_in_file(const std::string& path, int n, char old_value, char new_value, ReplaceStats* stats) {
+    int fd = open(path.c_str(), O_RDWR);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    // with n <= 0 nothing changes, the file is only mapped to count for stats
+    if (size == 0 || (n <= 0 && !stats_enabled(stats))) {
+        close(fd);
+        if (size == 0) {
+            record_stats(stats, 0, 0, 0, std::chrono::steady_clock::now());
+        }
+        return true;
+    }
+    int protection = n > 0 ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* mapped = mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    madvise(mapped, size, MADV_SEQUENTIAL);
+
+    char* data = static_cast<char*>(mapped);
+    replace_symbol(data, data + size, n, old_value, new_value, stats);
+
+    return munmap(mapped, size) == 0;
+}
+
+#else
+
+bool replace_symbol_in_file(const std::string&, int, char, char, ReplaceStats*) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,59 @@
+#include "../include/multi_replacer.hpp"
+
+MultiReplacer::MultiReplacer(std::span<const ReplaceRule> rules) {
+    // counting sort of the rules by character, keeping their order inside a character
+    std::array<uint32_t, 256> per_char{};
+    for (const ReplaceRule& rule : rules) {
+        if (rule.n > 0) {
+            ++per_char[static_cast<unsigned char>(rule.old_value)];
+        }
+    }
+    uint32_t offset = 0;
+    for (size_t c = 0; c < 256; ++c) {
+        table[c] = {offset, offset};
+        offset += per_char[c];
+    }
+    period.resize(offset);
+    need.resize(offset);
+    new_value.resize(offset);
+    for (const ReplaceRule& rule : rules) {
+        if (rule.n <= 0) {
+            continue;
+        }
+        uint32_t& pos = table[static_cast<unsigned char>(rule.old_value)].last;
+        period[pos] = rule.n;
+        need[pos] = rule.n;
+        new_value[pos] = rule.new_value;
+        ++pos;
+    }
+}
+
+void MultiReplacer::process(char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        Slot slot = table[static_cast<unsigned char>(data[i])];
+        bool replaced = false;
+        for (uint32_t k = slot.first; k < slot.last; ++k) {
+            if (--need[k] == 0) {
+                need[k] = period[k];
+                if (!replaced) {
+                    data[i] = new_value[k];
+                    replaced = true;
+                }
+            }
+        }
+    }
+}
+
+void MultiReplacer::reset() {
+    need = period;
+}
+
+std::string replace_symbols(std::string text, std::span<const ReplaceRule> rules) {
+    replace_symbols(std::span<char>(text), rules);
+    return text;
+}
+
+void replace_symbols(std::span<char> text, std::span<const ReplaceRule> rules) {
+    MultiReplacer replacer(rules);
+    replacer.process(text.data(), text.size());
+}
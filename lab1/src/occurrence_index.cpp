@@ -0,0 +1,141 @@
+#include "../include/occurrence_index.hpp"
+#include "../include/replacer_kernel.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <thread>
+
+namespace {
+
+// Smaller parts are not worth a thread
+constexpr size_t MIN_PART = 1 << 20;
+// parts cover whole 512-bit blocks, so they never share a word
+constexpr size_t PART_ALIGN = 512;
+
+}
+
+OccurrenceIndex::OccurrenceIndex(std::string_view text, char value, unsigned threads)
+    : low_bits(0), elias_fano(false), length(text.size()), total(0), symbol(value) {
+    std::vector<uint64_t> words((length + 63) / 64, 0);
+    auto build = [&](size_t begin, size_t end) {
+        if (begin < end) {
+            match_bits(text.data() + begin, end - begin, value, words.data() + begin / 64);
+        }
+    };
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t parts = std::clamp<size_t>(length / MIN_PART, 1, threads);
+    // rounded up twice, so parts * per_part never falls short of length
+    size_t per_part = ((length + parts - 1) / parts + PART_ALIGN - 1) / PART_ALIGN * PART_ALIGN;
+    {
+        std::vector<std::jthread> workers;
+        for (size_t p = 1; p < parts; ++p) {
+            size_t first = std::min(p * per_part, length);
+            workers.emplace_back(build, first, std::min(first + per_part, length));
+        }
+        build(0, std::min(per_part, length));
+    }
+
+    for (uint64_t word : words) {
+        total += std::popcount(word);
+    }
+    // low bits = floor(log2(n / m)) makes the high bitvector at most 3m bits
+    if (total > 0 && length / total > 1) {
+        low_bits = std::bit_width(length / total) - 1;
+    }
+    size_t high_size = total + (length >> low_bits) + 1;
+    if (total == 0 || total * low_bits + high_size >= length) {
+        bits = RankSelect(std::move(words), length);
+        return;
+    }
+
+    elias_fano = true;
+    std::vector<uint64_t> high((high_size + 63) / 64, 0);
+    lows.assign((total * low_bits + 63) / 64 + 1, 0);
+    size_t i = 0;
+    for (size_t w = 0; w < words.size(); ++w) {
+        for (uint64_t word = words[w]; word != 0; word &= word - 1, ++i) {
+            size_t pos = w * 64 + std::countr_zero(word);
+            size_t h = (pos >> low_bits) + i;
+            high[h / 64] |= uint64_t{1} << (h % 64);
+            if (low_bits > 0) {
+                uint64_t part = pos & ((uint64_t{1} << low_bits) - 1);
+                size_t at = i * low_bits;
+                lows[at / 64] |= part << (at % 64);
+                if (at % 64 + low_bits > 64) {
+                    lows[at / 64 + 1] |= part >> (64 - at % 64);
+                }
+            }
+        }
+    }
+    bits = RankSelect(std::move(high), high_size);
+}
+
+size_t OccurrenceIndex::low(size_t i) const {
+    if (low_bits == 0) {
+        return 0;
+    }
+    size_t at = i * low_bits;
+    uint64_t result = lows[at / 64] >> (at % 64);
+    if (at % 64 + low_bits > 64) {
+        result |= lows[at / 64 + 1] << (64 - at % 64);
+    }
+    return result & ((uint64_t{1} << low_bits) - 1);
+}
+
+char OccurrenceIndex::value() const {
+    return symbol;
+}
+
+size_t OccurrenceIndex::count() const {
+    return total;
+}
+
+size_t OccurrenceIndex::rank(size_t pos) const {
+    pos = std::min(pos, length);
+    if (!elias_fano) {
+        return bits.rank1(pos);
+    }
+    // occurrences with a smaller high part come before the bucket of pos,
+    // then the ones inside it are compared by their low bits
+    size_t bucket = pos >> low_bits;
+    size_t start = bucket == 0 ? 0 : bits.select0(bucket - 1) + 1;
+    size_t result = start - bucket;
+    size_t target = pos & ((uint64_t{1} << low_bits) - 1);
+    for (; start < bits.size() && bits.get(start) && low(result) < target; ++start) {
+        ++result;
+    }
+    return result;
+}
+
+size_t OccurrenceIndex::select(size_t k) const {
+    if (!elias_fano) {
+        return bits.select1(k - 1);
+    }
+    size_t high = bits.select1(k - 1) - (k - 1);
+    return high << low_bits | low(k - 1);
+}
+
+void OccurrenceIndex::replace(std::span<char> text, int n, char new_value) const {
+    if (n <= 0) {
+        return;
+    }
+    for (size_t k = n; k <= total; k += n) {
+        text[select(k)] = new_value;
+    }
+}
+
+std::string OccurrenceIndex::replace(std::string text, int n, char new_value) const {
+    replace(std::span<char>(text), n, new_value);
+    return text;
+}
+
+size_t OccurrenceIndex::memory_usage() const {
+    return bits.memory_usage() + lows.size() * sizeof(uint64_t);
+}
+
+bool OccurrenceIndex::compressed() const {
+    return elias_fano;
+}
@@ -0,0 +1,86 @@
+#include "../include/parallel_replacer.hpp"
+#include "../include/replacer.hpp"
+#include "../include/replacer_kernel.hpp"
+
+#include <algorithm>
+#include <barrier>
+#include <latch>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Smaller chunks are not worth a thread
+constexpr size_t MIN_CHUNK = 1 << 20;
+
+}
+
+std::string replace_symbol_parallel(std::string text, int n, char old_value, char new_value, unsigned threads,
+                                    ReplaceStats* stats) {
+    replace_symbol_parallel(std::span<char>(text), n, old_value, new_value, threads, stats);
+    return text;
+}
+
+void replace_symbol_parallel(std::span<char> text, int n, char old_value, char new_value, unsigned threads,
+                             ReplaceStats* stats) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t chunks = std::min<size_t>(threads, text.size() / MIN_CHUNK);
+    if (n <= 0 || chunks <= 1) {
+        replace_symbol(text, n, old_value, new_value, stats);
+        return;
+    }
+    auto start = stats_enabled(stats) ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+
+    size_t chunk_size = (text.size() + chunks - 1) / chunks;
+    std::vector<size_t> counts(chunks);
+    std::barrier counted(static_cast<std::ptrdiff_t>(chunks));
+
+    auto work = [&](size_t id) {
+        char* begin = text.data() + id * chunk_size;
+        size_t size = std::min(chunk_size, text.size() - id * chunk_size);
+        counts[id] = count_range(begin, size, old_value);
+        counted.arrive_and_wait();
+
+        // exclusive prefix sum: occurrences in all previous chunks
+        size_t before = 0;
+        for (size_t j = 0; j < id; ++j) {
+            before += counts[j];
+        }
+        replace_range(begin, size, n, old_value, new_value, before % n);
+    };
+
+    {
+        // Workers reach the barrier only once all of them exist: if starting one
+        // fails, the started ones return instead of waiting there forever
+        std::latch started(1);
+        bool failed = false;
+        auto worker = [&](size_t id) {
+            started.wait();
+            if (!failed) {
+                work(id);
+            }
+        };
+
+        std::vector<std::jthread> workers;
+        workers.reserve(chunks - 1);
+        try {
+            for (size_t id = 1; id < chunks; ++id) {
+                workers.emplace_back(worker, id);
+            }
+        } catch (...) {
+            failed = true;
+            started.count_down();
+            throw;
+        }
+        started.count_down();
+        work(0);
+    }
+    // the per-chunk counts already hold every match
+    size_t matches = 0;
+    for (size_t found : counts) {
+        matches += found;
+    }
+    record_stats(stats, text.size(), matches, matches / n, start);
+}
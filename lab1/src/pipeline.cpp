@@ -0,0 +1,162 @@
+#include "../include/pipeline.hpp"
+#include "../include/stream_replacer.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <latch>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+template <typename T>
+class BlockingQueue {
+public:
+    void push(T value) {
+        {
+            std::lock_guard lock(mutex);
+            items.push_back(value);
+        }
+        ready.notify_one();
+    }
+
+    // Blocks until an item is available, the waiting time is added to stall
+    T pop(std::chrono::nanoseconds& stall) {
+        auto start = Clock::now();
+        std::unique_lock lock(mutex);
+        ready.wait(lock, [this] { return !items.empty(); });
+        T value = items.front();
+        items.pop_front();
+        stall += Clock::now() - start;
+        return value;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<T> items;
+};
+
+struct Buffer {
+    std::vector<char> data;
+    size_t size = 0;
+};
+
+// Buffer index that marks the end of the input
+constexpr size_t END = static_cast<size_t>(-1);
+
+}
+
+bool replace_pipeline(std::FILE* in, std::FILE* out, int n, char old_value, char new_value,
+                      PipelineStats* stats, size_t buffer_size, size_t buffer_count, ReplaceStats* replace_stats) {
+    if (buffer_count == 0) {
+        buffer_count = 1;
+    }
+    std::vector<Buffer> ring(buffer_count);
+    for (Buffer& buffer : ring) {
+        buffer.data.resize(buffer_size > 0 ? buffer_size : 1);
+    }
+    BlockingQueue<size_t> free_buffers;
+    BlockingQueue<size_t> filled;
+    BlockingQueue<size_t> replaced;
+    for (size_t i = 0; i < buffer_count; ++i) {
+        free_buffers.push(i);
+    }
+
+    PipelineStats local;
+    bool read_ok = true;
+    bool write_ok = true;
+
+    // The stages start only once both threads exist: if starting the writer
+    // throws, the reader leaves instead of blocking on free_buffers forever
+    std::latch started(1);
+    bool failed = false;
+    auto read_loop = [&] {
+        started.wait();
+        if (failed) {
+            return;
+        }
+        while (true) {
+            size_t id = free_buffers.pop(local.read_stall);
+            auto start = Clock::now();
+            Buffer& buffer = ring[id];
+            buffer.size = std::fread(buffer.data.data(), 1, buffer.data.size(), in);
+            local.read_busy += Clock::now() - start;
+            if (buffer.size == 0) {
+                read_ok = !std::ferror(in);
+                filled.push(END);
+                return;
+            }
+            filled.push(id);
+        }
+    };
+    auto write_loop = [&] {
+        started.wait();
+        if (failed) {
+            return;
+        }
+        while (true) {
+            size_t id = replaced.pop(local.write_stall);
+            if (id == END) {
+                return;
+            }
+            auto start = Clock::now();
+            Buffer& buffer = ring[id];
+            // after an error the buffers are still drained so the other stages finish
+            if (write_ok) {
+                write_ok = std::fwrite(buffer.data.data(), 1, buffer.size, out) == buffer.size;
+            }
+            local.write_busy += Clock::now() - start;
+            free_buffers.push(id);
+        }
+    };
+
+    std::jthread reader;
+    std::jthread writer;
+    try {
+        reader = std::jthread(read_loop);
+        writer = std::jthread(write_loop);
+    } catch (...) {
+        failed = true;
+        started.count_down();
+        throw;
+    }
+    started.count_down();
+
+    StreamReplacer replacer(n, old_value, new_value, replace_stats);
+    while (true) {
+        size_t id = filled.pop(local.compute_stall);
+        if (id == END) {
+            replaced.push(END);
+            break;
+        }
+        auto start = Clock::now();
+        Buffer& buffer = ring[id];
+        replacer.process(buffer.data.data(), buffer.size);
+        local.compute_busy += Clock::now() - start;
+        local.bytes += buffer.size;
+        ++local.buffers;
+        replaced.push(id);
+    }
+
+    reader.join();
+    writer.join();
+    write_ok = write_ok && std::fflush(out) == 0;
+    if (stats != nullptr) {
+        *stats = local;
+    }
+    return read_ok && write_ok;
+}
+
+void print_stats(std::FILE* out, const PipelineStats& stats) {
+    auto ms = [](std::chrono::nanoseconds time) {
+        return std::chrono::duration<double, std::milli>(time).count();
+    };
+    std::fprintf(out, "bytes: %zu in %zu buffers\n", stats.bytes, stats.buffers);
+    std::fprintf(out, "read:    busy %.3f ms, stalled %.3f ms\n", ms(stats.read_busy), ms(stats.read_stall));
+    std::fprintf(out, "replace: busy %.3f ms, stalled %.3f ms\n", ms(stats.compute_busy), ms(stats.compute_stall));
+    std::fprintf(out, "write:   busy %.3f ms, stalled %.3f ms\n", ms(stats.write_busy), ms(stats.write_stall));
+}
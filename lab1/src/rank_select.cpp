@@ -0,0 +1,143 @@
+#include "../include/rank_select.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+namespace {
+
+// 512-bit blocks with 16-bit counters and a 64-bit counter every 64 blocks:
+// the rank directory takes about 3% on top of the bits
+constexpr size_t BLOCK_WORDS = 8;
+constexpr size_t BLOCK_BITS = BLOCK_WORDS * 64;
+constexpr size_t SUPER_BLOCKS = 64;
+
+constexpr uint64_t ONES_STEP_8 = 0x0101010101010101;
+constexpr uint64_t MSBS_STEP_8 = 0x8080808080808080;
+
+// Position of the (r + 1)-th set bit of every byte value
+constexpr std::array<std::array<uint8_t, 8>, 256> SELECT_IN_BYTE = [] {
+    std::array<std::array<uint8_t, 8>, 256> table{};
+    for (size_t byte = 0; byte < 256; ++byte) {
+        size_t r = 0;
+        for (uint8_t bit = 0; bit < 8; ++bit) {
+            if (byte >> bit & 1) {
+                table[byte][r++] = bit;
+            }
+        }
+    }
+    return table;
+}();
+
+// Position of the (r + 1)-th set bit of word, r < popcount(word). Byte
+// counts are summed in parallel, the byte holding the bit is the number of
+// prefix sums not above r, and a table finishes inside that byte.
+size_t select_in_word(uint64_t word, size_t r) {
+    uint64_t counts = word - ((word >> 1) & 0x5555555555555555);
+    counts = (counts & 0x3333333333333333) + ((counts >> 2) & 0x3333333333333333);
+    counts = (counts + (counts >> 4)) & 0x0F0F0F0F0F0F0F0F;
+    uint64_t prefix = counts * ONES_STEP_8;
+    // the top bit of a byte survives when its prefix sum is at most r
+    uint64_t not_above = ((r * ONES_STEP_8 | MSBS_STEP_8) - prefix) & MSBS_STEP_8;
+    size_t byte = std::popcount(not_above);
+    size_t before = byte == 0 ? 0 : (prefix >> (8 * byte - 8)) & 0xFF;
+    return 8 * byte + SELECT_IN_BYTE[(word >> (8 * byte)) & 0xFF][r - before];
+}
+
+}
+
+RankSelect::RankSelect(std::vector<uint64_t> words, size_t size) : bits(std::move(words)), length(size) {
+    size_t block_count = ((length + 63) / 64 + BLOCK_WORDS - 1) / BLOCK_WORDS;
+    bits.resize(block_count * BLOCK_WORDS, 0);
+    blocks.assign(block_count, 0);
+    supers.assign(block_count / SUPER_BLOCKS + 1, 0);
+
+    size_t before = 0;
+    for (size_t b = 0; b < block_count; ++b) {
+        if (b % SUPER_BLOCKS == 0) {
+            supers[b / SUPER_BLOCKS] = before;
+        }
+        blocks[b] = static_cast<uint16_t>(before - supers[b / SUPER_BLOCKS]);
+        for (size_t w = b * BLOCK_WORDS; w < (b + 1) * BLOCK_WORDS; ++w) {
+            before += std::popcount(bits[w]);
+        }
+        // the block holds the ones (zeros) with index k * SELECT_SAMPLE below
+        // the counts after it
+        size_t zeros = std::min((b + 1) * BLOCK_BITS, length) - before;
+        while (one_samples.size() * SELECT_SAMPLE < before) {
+            one_samples.push_back(static_cast<uint32_t>(b));
+        }
+        while (zero_samples.size() * SELECT_SAMPLE < zeros) {
+            zero_samples.push_back(static_cast<uint32_t>(b));
+        }
+    }
+    total = before;
+}
+
+size_t RankSelect::size() const {
+    return length;
+}
+
+size_t RankSelect::ones() const {
+    return total;
+}
+
+bool RankSelect::get(size_t pos) const {
+    return bits[pos / 64] >> (pos % 64) & 1;
+}
+
+size_t RankSelect::block_rank(size_t b) const {
+    if (b == blocks.size()) {
+        return total;
+    }
+    return supers[b / SUPER_BLOCKS] + blocks[b];
+}
+
+size_t RankSelect::rank1(size_t pos) const {
+    pos = std::min(pos, length);
+    size_t word = pos / 64;
+    size_t block = word / BLOCK_WORDS;
+    size_t result = block_rank(block);
+    for (size_t w = block * BLOCK_WORDS; w < word; ++w) {
+        result += std::popcount(bits[w]);
+    }
+    if (pos % 64 != 0) {
+        result += std::popcount(bits[word] & ((uint64_t{1} << (pos % 64)) - 1));
+    }
+    return result;
+}
+
+size_t RankSelect::select1(size_t r) const {
+    size_t b = one_samples[r / SELECT_SAMPLE];
+    while (b + 1 < blocks.size() && block_rank(b + 1) <= r) {
+        ++b;
+    }
+    r -= block_rank(b);
+    for (size_t w = b * BLOCK_WORDS;; ++w) {
+        size_t ones = std::popcount(bits[w]);
+        if (r < ones) {
+            return w * 64 + select_in_word(bits[w], r);
+        }
+        r -= ones;
+    }
+}
+
+size_t RankSelect::select0(size_t r) const {
+    size_t b = zero_samples[r / SELECT_SAMPLE];
+    while (b + 1 < blocks.size() && (b + 1) * BLOCK_BITS - block_rank(b + 1) <= r) {
+        ++b;
+    }
+    r -= b * BLOCK_BITS - block_rank(b);
+    for (size_t w = b * BLOCK_WORDS;; ++w) {
+        size_t zeros = 64 - std::popcount(bits[w]);
+        if (r < zeros) {
+            return w * 64 + select_in_word(~bits[w], r);
+        }
+        r -= zeros;
+    }
+}
+
+size_t RankSelect::memory_usage() const {
+    return (bits.size() + supers.size()) * sizeof(uint64_t) + blocks.size() * sizeof(uint16_t)
+        + (one_samples.size() + zero_samples.size()) * sizeof(uint32_t);
+}
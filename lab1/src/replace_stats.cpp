@@ -0,0 +1,9 @@
+#include "../include/replace_stats.hpp"
+
+std::string ReplaceStats::to_json() const {
+    return "{\"bytes_scanned\":" + std::to_string(bytes_scanned)
+        + ",\"matches\":" + std::to_string(matches)
+        + ",\"replacements\":" + std::to_string(replacements)
+        + ",\"chunks\":" + std::to_string(chunks)
+        + ",\"nanoseconds\":" + std::to_string(nanoseconds) + "}";
+}
@@ -1,17 +1,51 @@
 #include "../include/replacer.hpp"
+#include "../include/replacer_kernel.hpp"
 
-std::string replace_symbol(std::string text, int n, char old_value, char new_value) {
-    if (n <= 0) {
-        return text;
-    }
-    size_t sz = text.size();
-    size_t cnt = 0;
-    for (size_t i = 0; i < sz; ++i) {
-        if (text[i] == old_value) {
-            if (++cnt % n == 0) {
-                text[i] = new_value;
-            }
+std::string replace_symbol(std::string text, int n, char old_value, char new_value, ReplaceStats* stats) {
+    replace_symbol(std::span<char>(text), n, old_value, new_value, stats);
+    return text;
+}
+
+void replace_symbol(std::span<char> text, int n, char old_value, char new_value, ReplaceStats* stats) {
+    if (!stats_enabled(stats)) {
+        if (n > 0) {
+            replace_range(text.data(), text.size(), n, old_value, new_value);
         }
+        return;
     }
+    // the kernels only track the counter modulo n, so matches take a separate
+    // pass; it is timed with the rest as the cost of collecting statistics
+    auto start = std::chrono::steady_clock::now();
+    size_t matches = count_range(text.data(), text.size(), old_value);
+    if (n > 0) {
+        replace_range(text.data(), text.size(), n, old_value, new_value);
+    }
+    record_stats(stats, text.size(), matches, n > 0 ? matches / n : 0, start);
+}
+
+void replace_symbol(char* first, char* last, int n, char old_value, char new_value, ReplaceStats* stats) {
+    replace_symbol(std::span<char>(first, last), n, old_value, new_value, stats);
+}
+
+std::string replace_symbol(std::string text, int n, const CharClass& old_values, char new_value, ReplaceStats* stats) {
+    replace_symbol(std::span<char>(text), n, old_values, new_value, stats);
     return text;
-}
\ No newline at end of file
+}
+
+void replace_symbol(std::span<char> text, int n, const CharClass& old_values, char new_value, ReplaceStats* stats) {
+    if (!stats_enabled(stats)) {
+        if (n > 0) {
+            replace_class_range(old_values, text.data(), text.size(), n, new_value);
+        }
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    size_t matches = 0;
+    for (char c : text) {
+        matches += old_values.contains(c);
+    }
+    if (n > 0) {
+        replace_class_range(old_values, text.data(), text.size(), n, new_value);
+    }
+    record_stats(stats, text.size(), matches, n > 0 ? matches / n : 0, start);
+}
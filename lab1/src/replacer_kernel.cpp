@@ -0,0 +1,622 @@
+#include "../include/replacer_kernel.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define REPLACER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// All kernels keep `need` - how many more occurrences have to be seen before
+// the next replacement (1..n). Public functions speak in terms of count = n - need.
+using Kernel = size_t (*)(char*, size_t, size_t, char, char, size_t);
+using Counter = size_t (*)(const char*, size_t, char);
+using Finder = size_t (*)(std::string_view, std::string_view, size_t);
+using Matcher = void (*)(const char*, size_t, char, uint64_t*);
+using ClassKernel = size_t (*)(const CharClass&, char*, size_t, size_t, char, size_t);
+
+size_t replace_scalar(char* data, size_t size, size_t n, char old_value, char new_value, size_t need) {
+    for (size_t i = 0; i < size; ++i) {
+        if (data[i] == old_value && --need == 0) {
+            data[i] = new_value;
+            need = n;
+        }
+    }
+    return need;
+}
+
+size_t count_scalar(const char* data, size_t size, char old_value) {
+    size_t found = 0;
+    for (size_t i = 0; i < size; ++i) {
+        found += data[i] == old_value;
+    }
+    return found;
+}
+
+void match_scalar(const char* data, size_t size, char value, uint64_t* out) {
+    for (size_t word = 0; word * 64 < size; ++word) {
+        uint64_t bits = 0;
+        size_t len = size - word * 64 < 64 ? size - word * 64 : 64;
+        for (size_t j = 0; j < len; ++j) {
+            bits |= static_cast<uint64_t>(data[word * 64 + j] == value) << j;
+        }
+        out[word] = bits;
+    }
+}
+
+// pattern is at least 2 bytes long in all finders
+size_t find_scalar(std::string_view text, std::string_view pattern, size_t from) {
+    return text.find(pattern, from);
+}
+
+size_t replace_class_scalar(const CharClass& old_values, char* data, size_t size, size_t n, char new_value, size_t need) {
+    for (size_t i = 0; i < size; ++i) {
+        if (old_values.contains(data[i]) && --need == 0) {
+            data[i] = new_value;
+            need = n;
+        }
+    }
+    return need;
+}
+
+#ifdef REPLACER_X86
+
+__attribute__((target("sse2")))
+void match_sse2(const char* data, size_t size, char value, uint64_t* out) {
+    const __m128i needle = _mm_set1_epi8(value);
+    size_t word = 0;
+    for (; word * 64 + 64 <= size; ++word) {
+        uint64_t bits = 0;
+        for (int j = 0; j < 4; ++j) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + word * 64 + 16 * j));
+            bits |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)))) << (16 * j);
+        }
+        out[word] = bits;
+    }
+    match_scalar(data + word * 64, size - word * 64, value, out + word);
+}
+
+__attribute__((target("avx2")))
+void match_avx2(const char* data, size_t size, char value, uint64_t* out) {
+    const __m256i needle = _mm256_set1_epi8(value);
+    size_t word = 0;
+    for (; word * 64 + 64 <= size; ++word) {
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + word * 64));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + word * 64 + 32));
+        out[word] = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, needle)))
+            | static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, needle)))) << 32;
+    }
+    match_scalar(data + word * 64, size - word * 64, value, out + word);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+void match_avx512(const char* data, size_t size, char value, uint64_t* out) {
+    const __m512i needle = _mm512_set1_epi8(value);
+    size_t word = 0;
+    for (; word * 64 + 64 <= size; ++word) {
+        out[word] = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(data + word * 64), needle);
+    }
+    match_scalar(data + word * 64, size - word * 64, value, out + word);
+}
+
+// Checks the candidates of a block; bit j of mask means text[pos + j] and
+// text[pos + j + k - 1] match the ends of the pattern
+inline size_t check_candidates(const char* text, size_t pos, uint32_t mask, std::string_view pattern) {
+    while (mask != 0) {
+        size_t candidate = pos + std::countr_zero(mask);
+        if (std::memcmp(text + candidate + 1, pattern.data() + 1, pattern.size() - 2) == 0) {
+            return candidate;
+        }
+        mask &= mask - 1;
+    }
+    return std::string_view::npos;
+}
+
+__attribute__((target("sse2")))
+size_t find_sse2(std::string_view text, std::string_view pattern, size_t from) {
+    const size_t k = pattern.size();
+    const __m128i first = _mm_set1_epi8(pattern.front());
+    const __m128i last = _mm_set1_epi8(pattern.back());
+    size_t i = from;
+    for (; i + k - 1 + 16 <= text.size(); i += 16) {
+        __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i));
+        __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i + k - 1));
+        uint32_t mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)));
+        size_t found = check_candidates(text.data(), i, mask, pattern);
+        if (found != std::string_view::npos) {
+            return found;
+        }
+    }
+    return find_scalar(text, pattern, i);
+}
+
+__attribute__((target("avx2,bmi")))
+size_t find_avx2(std::string_view text, std::string_view pattern, size_t from) {
+    const size_t k = pattern.size();
+    const __m256i first = _mm256_set1_epi8(pattern.front());
+    const __m256i last = _mm256_set1_epi8(pattern.back());
+    size_t i = from;
+    for (; i + k - 1 + 32 <= text.size(); i += 32) {
+        __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + i));
+        __m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + i + k - 1));
+        uint32_t mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last)));
+        size_t found = check_candidates(text.data(), i, mask, pattern);
+        if (found != std::string_view::npos) {
+            return found;
+        }
+    }
+    return find_scalar(text, pattern, i);
+}
+
+// mask has bit i set when block[i] == old_value
+inline size_t apply_mask(char* block, uint64_t mask, size_t n, char new_value, size_t need) {
+    size_t found = std::popcount(mask);
+    if (found < need) {
+        // the next n-th occurrence is not in this block
+        return need - found;
+    }
+    while (true) {
+        for (size_t k = 1; k < need; ++k) {
+            mask &= mask - 1;
+        }
+        block[std::countr_zero(mask)] = new_value;
+        mask &= mask - 1;
+        found -= need;
+        need = n;
+        if (found < n) {
+            return n - found;
+        }
+    }
+}
+
+__attribute__((target("sse2,popcnt")))
+size_t replace_sse2(char* data, size_t size, size_t n, char old_value, char new_value, size_t need) {
+    const __m128i needle = _mm_set1_epi8(old_value);
+    const __m128i fill = _mm_set1_epi8(new_value);
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        __m128i v[4];
+        uint64_t mask = 0;
+        for (int j = 0; j < 4; ++j) {
+            v[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16 * j));
+            uint64_t part = static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v[j], needle)));
+            mask |= part << (16 * j);
+        }
+        if (mask == 0) {
+            continue;
+        }
+        if (n == 1) {
+            for (int j = 0; j < 4; ++j) {
+                __m128i eq = _mm_cmpeq_epi8(v[j], needle);
+                __m128i res = _mm_or_si128(_mm_and_si128(eq, fill), _mm_andnot_si128(eq, v[j]));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i + 16 * j), res);
+            }
+            continue;
+        }
+        need = apply_mask(data + i, mask, n, new_value, need);
+    }
+    return replace_scalar(data + i, size - i, n, old_value, new_value, need);
+}
+
+__attribute__((target("avx2,popcnt,bmi")))
+size_t replace_avx2(char* data, size_t size, size_t n, char old_value, char new_value, size_t need) {
+    const __m256i needle = _mm256_set1_epi8(old_value);
+    const __m256i fill = _mm256_set1_epi8(new_value);
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32));
+        __m256i eq_lo = _mm256_cmpeq_epi8(lo, needle);
+        __m256i eq_hi = _mm256_cmpeq_epi8(hi, needle);
+        uint64_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(eq_lo))
+            | static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(eq_hi))) << 32;
+        if (mask == 0) {
+            continue;
+        }
+        if (n == 1) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), _mm256_blendv_epi8(lo, fill, eq_lo));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i + 32), _mm256_blendv_epi8(hi, fill, eq_hi));
+            continue;
+        }
+        need = apply_mask(data + i, mask, n, new_value, need);
+    }
+    return replace_scalar(data + i, size - i, n, old_value, new_value, need);
+}
+
+__attribute__((target("avx512f,avx512bw,popcnt,bmi")))
+size_t replace_avx512(char* data, size_t size, size_t n, char old_value, char new_value, size_t need) {
+    const __m512i needle = _mm512_set1_epi8(old_value);
+    const __m512i fill = _mm512_set1_epi8(new_value);
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        __m512i block = _mm512_loadu_si512(data + i);
+        uint64_t mask = _mm512_cmpeq_epi8_mask(block, needle);
+        if (mask == 0) {
+            continue;
+        }
+        if (n == 1) {
+            _mm512_storeu_si512(data + i, _mm512_mask_blend_epi8(mask, block, fill));
+            continue;
+        }
+        need = apply_mask(data + i, mask, n, new_value, need);
+    }
+    return replace_scalar(data + i, size - i, n, old_value, new_value, need);
+}
+
+__attribute__((target("sse2,popcnt")))
+size_t count_sse2(const char* data, size_t size, char old_value) {
+    const __m128i needle = _mm_set1_epi8(old_value);
+    size_t found = 0;
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        found += std::popcount(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle))));
+    }
+    return found + count_scalar(data + i, size - i, old_value);
+}
+
+__attribute__((target("avx2,popcnt")))
+size_t count_avx2(const char* data, size_t size, char old_value) {
+    const __m256i needle = _mm256_set1_epi8(old_value);
+    size_t found = 0;
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        found += std::popcount(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle))));
+    }
+    return found + count_scalar(data + i, size - i, old_value);
+}
+
+__attribute__((target("avx512f,avx512bw,popcnt")))
+size_t count_avx512(const char* data, size_t size, char old_value) {
+    const __m512i needle = _mm512_set1_epi8(old_value);
+    size_t found = 0;
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        found += std::popcount(_mm512_cmpeq_epi8_mask(_mm512_loadu_si512(data + i), needle));
+    }
+    return found + count_scalar(data + i, size - i, old_value);
+}
+
+// Nibble tables of a class: bit h of low[l] (high[l]) is set when the byte
+// with high nibble h (h + 8) and low nibble l belongs to the class
+struct NibbleTables {
+    alignas(16) uint8_t low[16] = {};
+    alignas(16) uint8_t high[16] = {};
+    alignas(16) uint8_t bit[16] = {};
+
+    explicit NibbleTables(const CharClass& cls) {
+        for (int c = 0; c < 256; ++c) {
+            if (cls.contains(static_cast<char>(c))) {
+                (c < 128 ? low : high)[c & 15] |= 1 << ((c >> 4) & 7);
+            }
+        }
+        for (int h = 0; h < 16; ++h) {
+            bit[h] = 1 << (h & 7);
+        }
+    }
+};
+
+__attribute__((target("ssse3,popcnt")))
+size_t replace_class_ssse3(const CharClass& old_values, char* data, size_t size, size_t n, char new_value, size_t need) {
+    NibbleTables tables(old_values);
+    const __m128i low = _mm_load_si128(reinterpret_cast<const __m128i*>(tables.low));
+    const __m128i high = _mm_load_si128(reinterpret_cast<const __m128i*>(tables.high));
+    const __m128i bit = _mm_load_si128(reinterpret_cast<const __m128i*>(tables.bit));
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i fill = _mm_set1_epi8(new_value);
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        __m128i v[4];
+        __m128i member[4];
+        uint64_t mask = 0;
+        for (int j = 0; j < 4; ++j) {
+            v[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16 * j));
+            __m128i lo = _mm_and_si128(v[j], nibble);
+            __m128i hi = _mm_and_si128(_mm_srli_epi16(v[j], 4), nibble);
+            // bytes >= 0x80 take their row from the second table
+            __m128i upper = _mm_cmplt_epi8(v[j], zero);
+            __m128i row = _mm_or_si128(_mm_andnot_si128(upper, _mm_shuffle_epi8(low, lo)),
+                                       _mm_and_si128(upper, _mm_shuffle_epi8(high, lo)));
+            __m128i b = _mm_shuffle_epi8(bit, hi);
+            member[j] = _mm_cmpeq_epi8(_mm_and_si128(row, b), b);
+            mask |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(member[j]))) << (16 * j);
+        }
+        if (mask == 0) {
+            continue;
+        }
+        if (n == 1) {
+            for (int j = 0; j < 4; ++j) {
+                __m128i res = _mm_or_si128(_mm_and_si128(member[j], fill), _mm_andnot_si128(member[j], v[j]));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i + 16 * j), res);
+            }
+            continue;
+        }
+        need = apply_mask(data + i, mask, n, new_value, need);
+    }
+    return replace_class_scalar(old_values, data + i, size - i, n, new_value, need);
+}
+
+// Byte j of the result is 0xff when byte j of v belongs to the class
+__attribute__((target("avx2")))
+inline __m256i classify_avx2(__m256i v, __m256i low, __m256i high, __m256i bit) {
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    __m256i lo = _mm256_and_si256(v, nibble);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+    // blendv picks by the top bit of v, i.e. bytes >= 0x80 use the second table
+    __m256i row = _mm256_blendv_epi8(_mm256_shuffle_epi8(low, lo), _mm256_shuffle_epi8(high, lo), v);
+    __m256i b = _mm256_shuffle_epi8(bit, hi);
+    return _mm256_cmpeq_epi8(_mm256_and_si256(row, b), b);
+}
+
+__attribute__((target("avx2,popcnt,bmi")))
+size_t replace_class_avx2(const CharClass& old_values, char* data, size_t size, size_t n, char new_value, size_t need) {
+    NibbleTables tables(old_values);
+    const __m256i low = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(tables.low)));
+    const __m256i high = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(tables.high)));
+    const __m256i bit = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(tables.bit)));
+    const __m256i fill = _mm256_set1_epi8(new_value);
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32));
+        __m256i in_lo = classify_avx2(lo, low, high, bit);
+        __m256i in_hi = classify_avx2(hi, low, high, bit);
+        uint64_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(in_lo))
+            | static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(in_hi))) << 32;
+        if (mask == 0) {
+            continue;
+        }
+        if (n == 1) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), _mm256_blendv_epi8(lo, fill, in_lo));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i + 32), _mm256_blendv_epi8(hi, fill, in_hi));
+            continue;
+        }
+        need = apply_mask(data + i, mask, n, new_value, need);
+    }
+    return replace_class_scalar(old_values, data + i, size - i, n, new_value, need);
+}
+
+// 16-byte table repeated in all four lanes. Loaded from a replicated copy:
+// the lane broadcast and shuffle intrinsics trip -Wuninitialized in GCC 12's
+// headers.
+__attribute__((target("avx512f")))
+inline __m512i broadcast_table(const uint8_t* table) {
+    alignas(64) uint8_t wide[64];
+    for (int lane = 0; lane < 4; ++lane) {
+        std::memcpy(wide + 16 * lane, table, 16);
+    }
+    return _mm512_load_si512(wide);
+}
+
+__attribute__((target("avx512f,avx512bw,popcnt,bmi")))
+size_t replace_class_avx512(const CharClass& old_values, char* data, size_t size, size_t n, char new_value, size_t need) {
+    NibbleTables tables(old_values);
+    const __m512i low = broadcast_table(tables.low);
+    const __m512i high = broadcast_table(tables.high);
+    const __m512i bit = broadcast_table(tables.bit);
+    const __m512i nibble = _mm512_set1_epi8(0x0f);
+    const __m512i fill = _mm512_set1_epi8(new_value);
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        __m512i v = _mm512_loadu_si512(data + i);
+        __m512i lo = _mm512_and_si512(v, nibble);
+        __m512i hi = _mm512_and_si512(_mm512_srli_epi16(v, 4), nibble);
+        __mmask64 upper = _mm512_movepi8_mask(v);
+        __m512i row = _mm512_mask_blend_epi8(upper, _mm512_shuffle_epi8(low, lo), _mm512_shuffle_epi8(high, lo));
+        uint64_t mask = _mm512_test_epi8_mask(row, _mm512_shuffle_epi8(bit, hi));
+        if (mask == 0) {
+            continue;
+        }
+        if (n == 1) {
+            _mm512_storeu_si512(data + i, _mm512_mask_blend_epi8(mask, v, fill));
+            continue;
+        }
+        need = apply_mask(data + i, mask, n, new_value, need);
+    }
+    return replace_class_scalar(old_values, data + i, size - i, n, new_value, need);
+}
+
+#endif
+
+Counter counter_for(ReplacerIsa isa) {
+    switch (isa) {
+#ifdef REPLACER_X86
+        case ReplacerIsa::Sse2:
+            return count_sse2;
+        case ReplacerIsa::Avx2:
+            return count_avx2;
+        case ReplacerIsa::Avx512:
+            return count_avx512;
+#endif
+        default:
+            return count_scalar;
+    }
+}
+
+Counter best_counter() {
+    static const Counter counter = counter_for(detect_isa());
+    return counter;
+}
+
+Matcher matcher_for(ReplacerIsa isa) {
+    switch (isa) {
+#ifdef REPLACER_X86
+        case ReplacerIsa::Sse2:
+            return match_sse2;
+        case ReplacerIsa::Avx2:
+            return match_avx2;
+        case ReplacerIsa::Avx512:
+            return match_avx512;
+#endif
+        default:
+            return match_scalar;
+    }
+}
+
+Matcher best_matcher() {
+    static const Matcher matcher = matcher_for(detect_isa());
+    return matcher;
+}
+
+ClassKernel class_kernel_for(ReplacerIsa isa) {
+    switch (isa) {
+#ifdef REPLACER_X86
+        case ReplacerIsa::Sse2:
+            // pshufb came with SSSE3
+            return __builtin_cpu_supports("ssse3") ? replace_class_ssse3 : replace_class_scalar;
+        case ReplacerIsa::Avx2:
+            return replace_class_avx2;
+        case ReplacerIsa::Avx512:
+            return replace_class_avx512;
+#endif
+        default:
+            return replace_class_scalar;
+    }
+}
+
+ClassKernel best_class_kernel() {
+    static const ClassKernel kernel = class_kernel_for(detect_isa());
+    return kernel;
+}
+
+Finder finder_for(ReplacerIsa isa) {
+    switch (isa) {
+#ifdef REPLACER_X86
+        case ReplacerIsa::Sse2:
+            return find_sse2;
+        // no separate AVX-512 finder: verification dominates, not the filter
+        case ReplacerIsa::Avx2:
+        case ReplacerIsa::Avx512:
+            return find_avx2;
+#endif
+        default:
+            return find_scalar;
+    }
+}
+
+Finder best_finder() {
+    static const Finder finder = finder_for(detect_isa());
+    return finder;
+}
+
+size_t find_with(Finder finder, std::string_view text, std::string_view pattern, size_t from) {
+    if (from > text.size() || pattern.size() > text.size() - from) {
+        return std::string_view::npos;
+    }
+    if (pattern.size() < 2) {
+        return text.find(pattern, from);
+    }
+    return finder(text, pattern, from);
+}
+
+Kernel kernel_for(ReplacerIsa isa) {
+    switch (isa) {
+#ifdef REPLACER_X86
+        case ReplacerIsa::Sse2:
+            return replace_sse2;
+        case ReplacerIsa::Avx2:
+            return replace_avx2;
+        case ReplacerIsa::Avx512:
+            return replace_avx512;
+#endif
+        default:
+            return replace_scalar;
+    }
+}
+
+Kernel best_kernel() {
+    static const Kernel kernel = kernel_for(detect_isa());
+    return kernel;
+}
+
+}
+
+bool isa_supported(ReplacerIsa isa) {
+#ifdef REPLACER_X86
+    __builtin_cpu_init();
+    switch (isa) {
+        case ReplacerIsa::Scalar:
+            return true;
+        case ReplacerIsa::Sse2:
+            return __builtin_cpu_supports("sse2") && __builtin_cpu_supports("popcnt");
+        case ReplacerIsa::Avx2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt") && __builtin_cpu_supports("bmi");
+        case ReplacerIsa::Avx512:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+                && __builtin_cpu_supports("popcnt") && __builtin_cpu_supports("bmi");
+    }
+    return false;
+#else
+    return isa == ReplacerIsa::Scalar;
+#endif
+}
+
+ReplacerIsa detect_isa() {
+    for (ReplacerIsa isa : {ReplacerIsa::Avx512, ReplacerIsa::Avx2, ReplacerIsa::Sse2}) {
+        if (isa_supported(isa)) {
+            return isa;
+        }
+    }
+    return ReplacerIsa::Scalar;
+}
+
+const char* isa_name(ReplacerIsa isa) {
+    switch (isa) {
+        case ReplacerIsa::Scalar:
+            return "scalar";
+        case ReplacerIsa::Sse2:
+            return "sse2";
+        case ReplacerIsa::Avx2:
+            return "avx2";
+        case ReplacerIsa::Avx512:
+            return "avx512";
+    }
+    return "unknown";
+}
+
+size_t replace_range(char* data, size_t size, size_t n, char old_value, char new_value, size_t count) {
+    return n - best_kernel()(data, size, n, old_value, new_value, n - count % n);
+}
+
+size_t replace_range(ReplacerIsa isa, char* data, size_t size, size_t n, char old_value, char new_value, size_t count) {
+    return n - kernel_for(isa)(data, size, n, old_value, new_value, n - count % n);
+}
+
+size_t count_range(const char* data, size_t size, char old_value) {
+    return best_counter()(data, size, old_value);
+}
+
+size_t count_range(ReplacerIsa isa, const char* data, size_t size, char old_value) {
+    return counter_for(isa)(data, size, old_value);
+}
+
+size_t find_substring(std::string_view text, std::string_view pattern, size_t from) {
+    return find_with(best_finder(), text, pattern, from);
+}
+
+size_t find_substring(ReplacerIsa isa, std::string_view text, std::string_view pattern, size_t from) {
+    return find_with(finder_for(isa), text, pattern, from);
+}
+
+void match_bits(const char* data, size_t size, char value, uint64_t* out) {
+    best_matcher()(data, size, value, out);
+}
+
+void match_bits(ReplacerIsa isa, const char* data, size_t size, char value, uint64_t* out) {
+    matcher_for(isa)(data, size, value, out);
+}
+
+size_t replace_class_range(const CharClass& old_values, char* data, size_t size, size_t n, char new_value, size_t count) {
+    return n - best_class_kernel()(old_values, data, size, n, new_value, n - count % n);
+}
+
+size_t replace_class_range(ReplacerIsa isa, const CharClass& old_values, char* data, size_t size, size_t n, char new_value, size_t count) {
+    return n - class_kernel_for(isa)(old_values, data, size, n, new_value, n - count % n);
+}
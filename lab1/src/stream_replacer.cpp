@@ -0,0 +1,54 @@
+#include "../include/stream_replacer.hpp"
+#include "../include/replacer_kernel.hpp"
+
+#include <algorithm>
+#include <memory>
+
+StreamReplacer::StreamReplacer(int n, char old_value, char new_value, ReplaceStats* stats)
+    : n(n > 0 ? n : 0), old_value(old_value), new_value(new_value), count(0), stats(stats) {}
+
+void StreamReplacer::process(char* data, size_t size) {
+    if (!stats_enabled(stats)) {
+        if (n > 0) {
+            count = replace_range(data, size, n, old_value, new_value, count);
+        }
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    size_t matches = count_range(data, size, old_value);
+    size_t replaced = 0;
+    if (n > 0) {
+        replaced = (count + matches) / n;
+        count = replace_range(data, size, n, old_value, new_value, count);
+    }
+    record_stats(stats, size, matches, replaced, start);
+}
+
+std::string StreamReplacer::process(std::string chunk) {
+    process(chunk.data(), chunk.size());
+    return chunk;
+}
+
+void StreamReplacer::reset() {
+    count = 0;
+}
+
+size_t StreamReplacer::pending() const {
+    return count;
+}
+
+bool replace_stream(std::FILE* in, std::FILE* out, int n, char old_value, char new_value,
+                    size_t buffer_size, ReplaceStats* stats) {
+    StreamReplacer replacer(n, old_value, new_value, stats);
+    // an empty buffer would read nothing and end the copy at once
+    buffer_size = std::max<size_t>(buffer_size, 1);
+    auto buffer = std::make_unique<char[]>(buffer_size);
+    size_t read;
+    while ((read = std::fread(buffer.get(), 1, buffer_size, in)) > 0) {
+        replacer.process(buffer.get(), read);
+        if (std::fwrite(buffer.get(), 1, read, out) != read) {
+            return false;
+        }
+    }
+    return !std::ferror(in) && std::fflush(out) == 0;
+}
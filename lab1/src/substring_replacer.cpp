@@ -0,0 +1,46 @@
+#include "../include/substring_replacer.hpp"
+#include "../include/replacer_kernel.hpp"
+
+#include <cstring>
+
+std::string replace_substring(std::string_view text, int n, std::string_view old_value, std::string_view new_value) {
+    if (n <= 0 || old_value.empty()) {
+        return std::string(text);
+    }
+
+    size_t found = 0;
+    for (size_t pos = find_substring(text, old_value); pos != std::string_view::npos;
+         pos = find_substring(text, old_value, pos + old_value.size())) {
+        ++found;
+    }
+    size_t replaced = found / n;
+    if (replaced == 0) {
+        return std::string(text);
+    }
+
+    size_t size = text.size() - replaced * old_value.size() + replaced * new_value.size();
+    std::string result;
+    result.resize_and_overwrite(size, [&](char* out, size_t) {
+        size_t copied = 0;
+        size_t pos = 0;
+        size_t cnt = 0;
+        for (size_t left = replaced; left > 0;) {
+            pos = find_substring(text, old_value, pos);
+            if (++cnt % n != 0) {
+                pos += old_value.size();
+                continue;
+            }
+            std::memcpy(out, text.data() + copied, pos - copied);
+            out += pos - copied;
+            std::memcpy(out, new_value.data(), new_value.size());
+            out += new_value.size();
+            pos += old_value.size();
+            copied = pos;
+            --left;
+        }
+        // nothing is replaced after the last n-th occurrence
+        std::memcpy(out, text.data() + copied, text.size() - copied);
+        return size;
+    });
+    return result;
+}
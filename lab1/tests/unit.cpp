@@ -1,5 +1,22 @@
 #include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cctype>
+#include <random>
+#include <string_view>
+
+#include "../include/batch_replacer.hpp"
+#include "../include/fast_io.hpp"
+#include "../include/file_replacer.hpp"
+#include "../include/multi_replacer.hpp"
+#include "../include/occurrence_index.hpp"
+#include "../include/rank_select.hpp"
+#include "../include/parallel_replacer.hpp"
+#include "../include/pipeline.hpp"
 #include "../include/replacer.hpp"
+#include "../include/replacer_kernel.hpp"
+#include "../include/stream_replacer.hpp"
+#include "../include/substring_replacer.hpp"
 
 TEST(ExampleTest, BasicTest1) {
     EXPECT_EQ(replace_symbol("MAI is the best university in the world!", 2, 'e', '@'), "MAI is the b@st university in th@ world!");
@@ -23,4 +40,622 @@ TEST(ExampleTest, NegativeTest) {
 
 TEST(ExampleTest, GreatTest) {
     EXPECT_EQ(replace_symbol("MAI is the best university in the world!", 10, 'e', '@'), "MAI is the best university in the world!");
-}
\ No newline at end of file
+}
+
+std::string reference_replace(std::string text, int n, char old_value, char new_value) {
+    size_t cnt = 0;
+    for (char& c : text) {
+        if (c == old_value && n > 0 && ++cnt % n == 0) {
+            c = new_value;
+        }
+    }
+    return text;
+}
+
+std::string random_text(size_t size, unsigned seed, int alphabet) {
+    std::mt19937 gen(seed);
+    std::string text(size, ' ');
+    for (char& c : text) {
+        c = static_cast<char>('a' + gen() % alphabet);
+    }
+    return text;
+}
+
+TEST(KernelTest, AllIsaMatchReference) {
+    for (ReplacerIsa isa : {ReplacerIsa::Scalar, ReplacerIsa::Sse2, ReplacerIsa::Avx2, ReplacerIsa::Avx512}) {
+        if (!isa_supported(isa)) {
+            continue;
+        }
+        for (int alphabet : {1, 2, 5, 40}) {
+            for (size_t size : {0, 1, 63, 64, 65, 200, 4099}) {
+                for (int n : {1, 2, 3, 7, 64, 65, 1000}) {
+                    std::string text = random_text(size, size * 31 + n, alphabet);
+                    std::string expected = reference_replace(text, n, 'a', '#');
+                    replace_range(isa, text.data(), text.size(), n, 'a', '#');
+                    EXPECT_EQ(text, expected) << isa_name(isa) << " size=" << size << " n=" << n;
+                }
+            }
+        }
+    }
+}
+
+TEST(KernelTest, CountCarriesAcrossCalls) {
+    std::string text = random_text(1000, 7, 3);
+    std::string expected = reference_replace(text, 5, 'b', '*');
+    size_t count = 0;
+    for (size_t pos = 0; pos < text.size(); pos += 77) {
+        size_t len = std::min<size_t>(77, text.size() - pos);
+        count = replace_range(text.data() + pos, len, 5, 'b', '*', count);
+    }
+    EXPECT_EQ(text, expected);
+}
+
+TEST(KernelTest, DetectedIsaIsSupported) {
+    EXPECT_TRUE(isa_supported(detect_isa()));
+}
+
+TEST(StreamTest, ChunksMatchWholeText) {
+    std::string text = random_text(5000, 11, 4);
+    std::string expected = replace_symbol(text, 3, 'c', '!');
+    for (size_t chunk : {1, 7, 64, 1000}) {
+        StreamReplacer replacer(3, 'c', '!');
+        std::string result;
+        for (size_t pos = 0; pos < text.size(); pos += chunk) {
+            result += replacer.process(text.substr(pos, chunk));
+        }
+        EXPECT_EQ(result, expected) << "chunk=" << chunk;
+    }
+}
+
+TEST(StreamTest, ResetStartsNewText) {
+    StreamReplacer replacer(2, 'a', 'b');
+    EXPECT_EQ(replacer.process("a"), "a");
+    EXPECT_EQ(replacer.pending(), 1);
+    replacer.reset();
+    EXPECT_EQ(replacer.process("aa"), "ab");
+}
+
+TEST(StreamTest, NonPositiveNPassesThrough) {
+    StreamReplacer replacer(0, 'a', 'b');
+    EXPECT_EQ(replacer.process("aaaa"), "aaaa");
+}
+
+TEST(StreamTest, ReplaceStreamThroughFiles) {
+    std::string text = random_text(100000, 3, 6);
+    std::FILE* in = std::tmpfile();
+    ASSERT_NE(in, nullptr);
+    std::fwrite(text.data(), 1, text.size(), in);
+
+    // buffer_size 0 is taken as 1
+    for (size_t buffer_size : {4096, 0}) {
+        std::rewind(in);
+        std::FILE* out = std::tmpfile();
+        ASSERT_NE(out, nullptr);
+        ASSERT_TRUE(replace_stream(in, out, 4, 'd', '_', buffer_size));
+
+        std::rewind(out);
+        std::string result(text.size(), '\0');
+        ASSERT_EQ(std::fread(result.data(), 1, result.size(), out), text.size());
+        EXPECT_EQ(result, replace_symbol(text, 4, 'd', '_'));
+        std::fclose(out);
+    }
+    std::fclose(in);
+}
+
+TEST(InPlaceTest, SpanAndPointers) {
+    std::string text = "MAI is the best university in the world!";
+    replace_symbol(std::span<char>(text), 2, 'e', '@');
+    EXPECT_EQ(text, "MAI is the b@st university in th@ world!");
+
+    char buffer[] = "Tyring machine forever!";
+    replace_symbol(buffer, buffer + sizeof(buffer) - 1, 3, 'r', 'R');
+    EXPECT_STREQ(buffer, "Tyring machine foreveR!");
+
+    std::string untouched = "aaaa";
+    replace_symbol(std::span<char>(untouched), 0, 'a', 'b');
+    EXPECT_EQ(untouched, "aaaa");
+}
+
+TEST(InPlaceTest, MappedFile) {
+    std::string text = random_text(70000, 5, 3);
+    std::string path = testing::TempDir() + "replacer_mmap.txt";
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    std::fwrite(text.data(), 1, text.size(), file);
+    std::fclose(file);
+
+    ASSERT_TRUE(replace_symbol_in_file(path, 6, 'a', '-'));
+
+    file = std::fopen(path.c_str(), "rb");
+    ASSERT_NE(file, nullptr);
+    std::string result(text.size(), '\0');
+    ASSERT_EQ(std::fread(result.data(), 1, result.size(), file), text.size());
+    std::fclose(file);
+    std::remove(path.c_str());
+    EXPECT_EQ(result, replace_symbol(text, 6, 'a', '-'));
+
+    EXPECT_FALSE(replace_symbol_in_file(path + ".missing", 6, 'a', '-'));
+}
+
+TEST(StatsTest, MappedFileWithNonPositiveN) {
+    std::string path = testing::TempDir() + "replacer_mmap_stats.txt";
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    std::fputs("abcabca", file);
+    std::fclose(file);
+
+    // файл не меняется, но вызов всё равно учитывается
+    ReplaceStats stats;
+    ASSERT_TRUE(replace_symbol_in_file(path, 0, 'a', '-', &stats));
+    file = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    std::fclose(file);
+    ASSERT_TRUE(replace_symbol_in_file(path, 2, 'a', '-', &stats));
+    std::remove(path.c_str());
+#if REPLACER_STATS
+    EXPECT_EQ(stats.chunks, 2);
+    EXPECT_EQ(stats.bytes_scanned, 7);
+    EXPECT_EQ(stats.matches, 3);
+    EXPECT_EQ(stats.replacements, 0);
+#else
+    EXPECT_EQ(stats.chunks, 0);
+#endif
+}
+
+TEST(KernelTest, CountMatchesReference) {
+    for (ReplacerIsa isa : {ReplacerIsa::Scalar, ReplacerIsa::Sse2, ReplacerIsa::Avx2, ReplacerIsa::Avx512}) {
+        if (!isa_supported(isa)) {
+            continue;
+        }
+        for (size_t size : {0, 15, 16, 33, 64, 1001}) {
+            std::string text = random_text(size, size, 3);
+            EXPECT_EQ(count_range(isa, text.data(), text.size(), 'a'), std::count(text.begin(), text.end(), 'a'))
+                << isa_name(isa) << " size=" << size;
+        }
+    }
+}
+
+TEST(ParallelTest, MatchesSequential) {
+    std::string text = random_text((5 << 20) + 123, 42, 7);
+    for (int n : {1, 3, 1000003}) {
+        for (unsigned threads : {1u, 2u, 3u, 5u}) {
+            EXPECT_EQ(replace_symbol_parallel(text, n, 'a', '#', threads), replace_symbol(text, n, 'a', '#'))
+                << "n=" << n << " threads=" << threads;
+        }
+    }
+}
+
+TEST(ParallelTest, SmallAndInvalidInput) {
+    EXPECT_EQ(replace_symbol_parallel("Tyring machine forever!", 3, 'r', 'R'), "Tyring machine foreveR!");
+    EXPECT_EQ(replace_symbol_parallel("aaaa", -1, 'a', 'b'), "aaaa");
+}
+
+TEST(MultiRuleTest, DifferentCharsMatchSeparateCalls) {
+    std::string text = random_text(3000, 9, 5);
+    std::vector<ReplaceRule> rules = {{2, 'a', 'A'}, {3, 'b', 'B'}, {1, 'c', 'C'}, {0, 'd', 'D'}};
+    std::string expected = text;
+    for (const ReplaceRule& rule : rules) {
+        expected = replace_symbol(expected, rule.n, rule.old_value, rule.new_value);
+    }
+    EXPECT_EQ(replace_symbols(text, rules), expected);
+}
+
+TEST(MultiRuleTest, SameCharFirstRuleWins) {
+    // every 2nd 'a' -> '2', every 3rd 'a' -> '3', the 6th 'a' is claimed by the first rule
+    std::vector<ReplaceRule> rules = {{2, 'a', '2'}, {3, 'a', '3'}};
+    EXPECT_EQ(replace_symbols("aaaaaaa", rules), "a232a2a");
+}
+
+TEST(MultiRuleTest, RulesSeeOriginalText) {
+    std::vector<ReplaceRule> rules = {{1, 'a', 'b'}, {1, 'b', 'c'}};
+    EXPECT_EQ(replace_symbols("ab", rules), "bc");
+}
+
+TEST(MultiRuleTest, StateCarriesAcrossChunks) {
+    std::vector<ReplaceRule> rules = {{2, 'x', '1'}, {3, 'x', '2'}};
+    MultiReplacer replacer(rules);
+    std::string first = "xxx";
+    std::string second = "xxx";
+    replacer.process(first.data(), first.size());
+    replacer.process(second.data(), second.size());
+    EXPECT_EQ(first + second, "x121x1");
+
+    std::string again = "xxx";
+    replacer.reset();
+    replacer.process(again.data(), again.size());
+    EXPECT_EQ(again, "x12");
+}
+
+template <int N, char Old, char New, size_t Size>
+constexpr bool replaced_equals(const char (&text)[Size], std::string_view expected) {
+    char buffer[Size] = {};
+    for (size_t i = 0; i < Size; ++i) {
+        buffer[i] = text[i];
+    }
+    replace_symbol<N, Old, New>(std::span<char>(buffer, Size - 1));
+    return std::string_view(buffer, Size - 1) == expected;
+}
+
+static_assert(replaced_equals<2, 'e', '@'>("MAI is the best university in the world!", "MAI is the b@st university in th@ world!"));
+static_assert(replaced_equals<1, 'a', '#'>("banana", "b#n#n#"));
+static_assert(replaced_equals<4, 'a', '#'>("aaaaaaaa", "aaa#aaa#"));
+static_assert(replaced_equals<0, 'a', '#'>("banana", "banana"));
+
+TEST(CompileTimeTest, MatchesRuntimeVersion) {
+    std::string text = random_text(1000, 17, 3);
+    EXPECT_EQ((replace_symbol<1, 'a', '!'>(text)), replace_symbol(text, 1, 'a', '!'));
+    EXPECT_EQ((replace_symbol<3, 'a', '!'>(text)), replace_symbol(text, 3, 'a', '!'));
+    EXPECT_EQ((replace_symbol<8, 'a', '!'>(text)), replace_symbol(text, 8, 'a', '!'));
+    EXPECT_EQ((replace_symbol<-2, 'a', '!'>(text)), text);
+
+    std::string in_place = text;
+    replace_symbol<4, 'b', '?'>(std::span<char>(in_place));
+    EXPECT_EQ(in_place, replace_symbol(text, 4, 'b', '?'));
+}
+
+std::string run_batch(const std::string& input, CounterMode mode, bool& ok) {
+    std::FILE* in = std::tmpfile();
+    std::FILE* out = std::tmpfile();
+    std::fwrite(input.data(), 1, input.size(), in);
+    std::rewind(in);
+    ok = replace_batch(in, out, mode);
+    std::string result(std::ftell(out), '\0');
+    std::rewind(out);
+    result.resize(std::fread(result.data(), 1, result.size(), out));
+    std::fclose(in);
+    std::fclose(out);
+    return result;
+}
+
+TEST(BatchTest, PerLineCounter) {
+    bool ok = false;
+    std::string result = run_batch("MAI is the best university in the world!\n2 e @\naaa\n2 a b\naaa\n  1 a   c", CounterMode::PerLine, ok);
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(result, "MAI is the b@st university in th@ world!\naba\nccc\n");
+}
+
+TEST(BatchTest, RunningCounter) {
+    bool ok = false;
+    // 'a' is counted across records: 3 + 3 occurrences, every 2nd one is replaced
+    std::string result = run_batch("aaa\n2 a b\naaa\n2 a b\nxa\n0 a b\n", CounterMode::Stream, ok);
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(result, "aba\nbab\nxa\n");
+}
+
+TEST(BatchTest, MalformedInput) {
+    bool ok = true;
+    run_batch("text\nnot a rule\n", CounterMode::PerLine, ok);
+    EXPECT_FALSE(ok);
+    run_batch("text without rule\n", CounterMode::PerLine, ok);
+    EXPECT_FALSE(ok);
+    run_batch("", CounterMode::PerLine, ok);
+    EXPECT_TRUE(ok);
+}
+
+TEST(FastIoTest, LinesLongerThanBuffer) {
+    std::string long_line = random_text(1000, 1, 20);
+    std::string input = long_line + "\nshort\n" + long_line;
+    std::FILE* in = std::tmpfile();
+    std::fwrite(input.data(), 1, input.size(), in);
+    std::rewind(in);
+
+    BufferedReader reader(in, 16);
+    std::span<char> line;
+    ASSERT_TRUE(reader.read_line(line));
+    EXPECT_EQ(std::string_view(line.data(), line.size()), long_line);
+    std::span<char> pair[2];
+    ASSERT_TRUE(reader.read_lines(pair));
+    EXPECT_EQ(std::string_view(pair[0].data(), pair[0].size()), "short");
+    EXPECT_EQ(std::string_view(pair[1].data(), pair[1].size()), long_line);
+    EXPECT_FALSE(reader.read_line(line));
+    EXPECT_TRUE(reader.exhausted());
+    std::fclose(in);
+}
+
+TEST(PipelineTest, MatchesReplaceSymbol) {
+    std::string text = random_text(300000, 23, 5);
+    for (size_t buffers : {1, 2, 4}) {
+        std::FILE* in = std::tmpfile();
+        std::FILE* out = std::tmpfile();
+        std::fwrite(text.data(), 1, text.size(), in);
+        std::rewind(in);
+
+        PipelineStats stats;
+        ASSERT_TRUE(replace_pipeline(in, out, 3, 'e', '3', &stats, 4096, buffers));
+        EXPECT_EQ(stats.bytes, text.size());
+        EXPECT_EQ(stats.buffers, (text.size() + 4095) / 4096);
+
+        std::rewind(out);
+        std::string result(text.size(), '\0');
+        ASSERT_EQ(std::fread(result.data(), 1, result.size(), out), text.size());
+        EXPECT_EQ(result, replace_symbol(text, 3, 'e', '3')) << "buffers=" << buffers;
+        std::fclose(in);
+        std::fclose(out);
+    }
+}
+
+std::string reference_substring(std::string text, int n, const std::string& old_value, const std::string& new_value) {
+    std::string result;
+    size_t cnt = 0;
+    size_t copied = 0;
+    for (size_t pos = text.find(old_value); pos != std::string::npos; pos = text.find(old_value, pos + old_value.size())) {
+        if (++cnt % n == 0) {
+            result += text.substr(copied, pos - copied) + new_value;
+            copied = pos + old_value.size();
+        }
+    }
+    return result + text.substr(copied);
+}
+
+TEST(SubstringTest, Basic) {
+    EXPECT_EQ(replace_substring("ERR ok ERR ok ERR", 2, "ERR", "ERROR"), "ERR ok ERROR ok ERR");
+    EXPECT_EQ(replace_substring("ERR ok ERR ok ERR", 1, "ERR", "E"), "E ok E ok E");
+    EXPECT_EQ(replace_substring("aaaa", 1, "aa", "b"), "bb");
+    EXPECT_EQ(replace_substring("aaa", 1, "aa", ""), "a");
+    EXPECT_EQ(replace_substring("MAI is the best university in the world!", 2, "e", "@"), "MAI is the b@st university in th@ world!");
+    EXPECT_EQ(replace_substring("abc", 0, "b", "x"), "abc");
+    EXPECT_EQ(replace_substring("abc", 1, "", "x"), "abc");
+    EXPECT_EQ(replace_substring("abc", 1, "abcd", "x"), "abc");
+}
+
+TEST(SubstringTest, MatchesReference) {
+    for (int alphabet : {2, 3, 26}) {
+        std::string text = random_text(5000, alphabet, alphabet);
+        for (std::string old_value : {"a", "ab", "aba", "abcab", "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"}) {
+            for (int n : {1, 2, 5}) {
+                EXPECT_EQ(replace_substring(text, n, old_value, "<*>"), reference_substring(text, n, old_value, "<*>"))
+                    << old_value << " n=" << n;
+            }
+        }
+    }
+}
+
+TEST(KernelTest, FindSubstringAllIsa) {
+    std::string text = random_text(3000, 99, 3);
+    for (ReplacerIsa isa : {ReplacerIsa::Scalar, ReplacerIsa::Sse2, ReplacerIsa::Avx2, ReplacerIsa::Avx512}) {
+        if (!isa_supported(isa)) {
+            continue;
+        }
+        for (std::string pattern : {"ab", "abc", "cabbac", "abcabcabcabcabcabcabcabcabcabcabcabc"}) {
+            for (size_t from : {0, 1, 100, 2990, 3000, 4000}) {
+                EXPECT_EQ(find_substring(isa, text, pattern, from), std::string_view(text).find(pattern, from))
+                    << isa_name(isa) << " " << pattern << " from=" << from;
+            }
+        }
+    }
+}
+
+TEST(KernelTest, MatchBitsAllIsa) {
+    std::string text = random_text(1000, 4, 3);
+    std::vector<uint64_t> expected((text.size() + 63) / 64);
+    for (size_t i = 0; i < text.size(); ++i) {
+        expected[i / 64] |= static_cast<uint64_t>(text[i] == 'b') << (i % 64);
+    }
+    for (ReplacerIsa isa : {ReplacerIsa::Scalar, ReplacerIsa::Sse2, ReplacerIsa::Avx2, ReplacerIsa::Avx512}) {
+        if (!isa_supported(isa)) {
+            continue;
+        }
+        std::vector<uint64_t> bits(expected.size());
+        match_bits(isa, text.data(), text.size(), 'b', bits.data());
+        EXPECT_EQ(bits, expected) << isa_name(isa);
+    }
+}
+
+TEST(RankSelectTest, MatchesReference) {
+    std::mt19937 gen(11);
+    // плотности от пустого до полного вектора, в том числе длинные пустые участки
+    for (unsigned per_mille : {0u, 1u, 10u, 500u, 999u, 1000u}) {
+        for (size_t size : {0, 1, 63, 64, 65, 511, 512, 513, 200000}) {
+            std::vector<uint64_t> words((size + 63) / 64, 0);
+            std::vector<size_t> ones;
+            std::vector<size_t> zeros;
+            for (size_t i = 0; i < size; ++i) {
+                bool clustered = per_mille == 10 && i % 50000 < 25000;
+                if (!clustered && gen() % 1000 < per_mille) {
+                    words[i / 64] |= uint64_t{1} << (i % 64);
+                    ones.push_back(i);
+                } else {
+                    zeros.push_back(i);
+                }
+            }
+            RankSelect bits(words, size);
+            ASSERT_EQ(bits.ones(), ones.size());
+            for (size_t r = 0; r < ones.size(); r += 1 + r % 7) {
+                ASSERT_EQ(bits.select1(r), ones[r]) << "density=" << per_mille << " size=" << size << " r=" << r;
+                ASSERT_EQ(bits.rank1(ones[r]), r);
+                ASSERT_TRUE(bits.get(ones[r]));
+            }
+            for (size_t r = 0; r < zeros.size(); r += 1 + r % 7) {
+                ASSERT_EQ(bits.select0(r), zeros[r]) << "density=" << per_mille << " size=" << size << " r=" << r;
+                ASSERT_EQ(bits.rank1(zeros[r]), zeros[r] - r);
+            }
+            ASSERT_EQ(bits.rank1(size), ones.size());
+        }
+    }
+}
+
+TEST(OccurrenceIndexTest, RankSelect) {
+    // алфавит 40 и 8 - редкий символ (Elias-Fano), 2 и 1 - частый (битовый вектор)
+    for (int alphabet : {40, 8, 2, 1}) {
+        std::string text = random_text(100000, 8, alphabet);
+        OccurrenceIndex index(text, 'a', 3);
+        EXPECT_EQ(index.compressed(), alphabet > 2) << "alphabet=" << alphabet;
+        std::vector<size_t> positions;
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text[i] == 'a') {
+                positions.push_back(i);
+            }
+        }
+        ASSERT_EQ(index.count(), positions.size());
+        for (size_t k = 1; k <= positions.size(); k += 37) {
+            EXPECT_EQ(index.select(k), positions[k - 1]) << "alphabet=" << alphabet << " k=" << k;
+            EXPECT_EQ(index.rank(positions[k - 1]), k - 1);
+            EXPECT_EQ(index.rank(positions[k - 1] + 1), k);
+        }
+        for (size_t pos = 0; pos <= text.size(); pos += 101) {
+            EXPECT_EQ(index.rank(pos), std::lower_bound(positions.begin(), positions.end(), pos) - positions.begin())
+                << "alphabet=" << alphabet << " pos=" << pos;
+        }
+        EXPECT_EQ(index.select(positions.size()), positions.back());
+        EXPECT_EQ(index.rank(text.size()), positions.size());
+        EXPECT_LT(index.memory_usage(), text.size() / 8 + text.size() / 100);
+        if (alphabet == 40) {
+            // несколько процентов от текста для редкого символа
+            EXPECT_LT(index.memory_usage(), text.size() / 30);
+        }
+    }
+}
+
+TEST(OccurrenceIndexTest, ReplaceMatchesReplaceSymbol) {
+    for (int alphabet : {10, 2}) {
+        std::string text = random_text((3 << 20) + 5, 12, alphabet);
+        OccurrenceIndex index(text, 'b', 4);
+        EXPECT_EQ(index.value(), 'b');
+        for (int n : {1, 2, 7, 1000, 0}) {
+            EXPECT_EQ(index.replace(text, n, '%'), replace_symbol(text, n, 'b', '%')) << "alphabet=" << alphabet << " n=" << n;
+        }
+    }
+
+    // длина делится на части с остатком, а частное кратно 512: хвост не теряется
+    std::string tail(2 << 20, 'x');
+    tail.push_back('a');
+    EXPECT_EQ(OccurrenceIndex(tail, 'a', 2).count(), 1);
+    std::string all((3 << 20) + 2, 'a');
+    OccurrenceIndex dense(all, 'a', 4);
+    EXPECT_EQ(dense.count(), all.size());
+    EXPECT_EQ(dense.replace(all, 1, 'B'), std::string(all.size(), 'B'));
+
+    OccurrenceIndex empty("", 'a');
+    EXPECT_EQ(empty.count(), 0);
+    EXPECT_EQ(empty.replace(std::string(), 1, 'b'), "");
+}
+
+TEST(CharClassTest, Predefined) {
+    for (int c = 0; c < 256; ++c) {
+        char ch = static_cast<char>(c);
+        EXPECT_EQ(CharClass::digits().contains(ch), c < 128 && std::isdigit(c) != 0);
+        EXPECT_EQ(CharClass::whitespace().contains(ch), c < 128 && std::isspace(c) != 0);
+        EXPECT_EQ(CharClass::letters().contains(ch), c < 128 && std::isalpha(c) != 0);
+        EXPECT_EQ(CharClass::punctuation().contains(ch), c < 128 && std::ispunct(c) != 0);
+    }
+}
+
+TEST(CharClassTest, ReplaceEveryNthDigit) {
+    EXPECT_EQ(replace_symbol("a1b2c3d4 5 6", 2, CharClass::digits(), '#'), "a1b#c3d# 5 #");
+    EXPECT_EQ(replace_symbol("a b\tc\nd", 1, CharClass::whitespace(), '_'), "a_b_c_d");
+    EXPECT_EQ(replace_symbol("123", 0, CharClass::digits(), '#'), "123");
+}
+
+TEST(CharClassTest, AllIsaMatchReference) {
+    // bytes from the whole 0..255 range to exercise both nibble tables
+    std::mt19937 gen(5);
+    std::string text(4000, ' ');
+    for (char& c : text) {
+        c = static_cast<char>(gen());
+    }
+    CharClass cls = CharClass::digits() | CharClass("\x80\xff\x7f\x01");
+    cls.add_range('\xa0', '\xaf');
+    // n == 1 идёт по отдельной ветке без маски
+    for (size_t n : {1, 3}) {
+        std::string expected = text;
+        size_t cnt = 0;
+        for (char& c : expected) {
+            if (cls.contains(c) && ++cnt % n == 0) {
+                c = '*';
+            }
+        }
+        for (ReplacerIsa isa : {ReplacerIsa::Scalar, ReplacerIsa::Sse2, ReplacerIsa::Avx2, ReplacerIsa::Avx512}) {
+            if (!isa_supported(isa)) {
+                continue;
+            }
+            std::string result = text;
+            size_t count = 0;
+            // uneven pieces to check that the shared counter carries over
+            for (size_t pos = 0; pos < result.size(); pos += 999) {
+                count = replace_class_range(isa, cls, result.data() + pos, std::min<size_t>(999, result.size() - pos), n, '*', count);
+            }
+            EXPECT_EQ(result, expected) << isa_name(isa) << " n=" << n;
+        }
+    }
+}
+
+TEST(StatsTest, ReplaceSymbolCounts) {
+    ReplaceStats stats;
+    EXPECT_EQ(replace_symbol("MAI is the best university in the world!", 2, 'e', '@', &stats), "MAI is the b@st university in th@ world!");
+    EXPECT_EQ(replace_symbol("aaaaa", 2, 'a', 'b', &stats), "ababa");
+#if REPLACER_STATS
+    EXPECT_EQ(stats.bytes_scanned, 45);
+    EXPECT_EQ(stats.matches, 4 + 5);
+    EXPECT_EQ(stats.replacements, 2 + 2);
+    EXPECT_EQ(stats.chunks, 2);
+#else
+    EXPECT_EQ(stats.chunks, 0);
+#endif
+}
+
+TEST(StatsTest, ClassParallelAndNonPositiveN) {
+    ReplaceStats stats;
+    EXPECT_EQ(replace_symbol("a1b22c333", 2, CharClass::digits(), '#', &stats), "a1b#2c#3#");
+    EXPECT_EQ(replace_symbol("aaaa", 0, 'a', 'b', &stats), "aaaa");
+    std::string text = random_text((4 << 20) + 7, 5, 4);
+    EXPECT_EQ(replace_symbol_parallel(text, 3, 'a', '#', 4, &stats), replace_symbol(text, 3, 'a', '#'));
+#if REPLACER_STATS
+    size_t matches = std::count(text.begin(), text.end(), 'a');
+    EXPECT_EQ(stats.chunks, 3);
+    EXPECT_EQ(stats.bytes_scanned, 9 + 4 + text.size());
+    EXPECT_EQ(stats.matches, 6 + 4 + matches);
+    EXPECT_EQ(stats.replacements, 3 + 0 + matches / 3);
+    EXPECT_GT(stats.nanoseconds, 0);
+#else
+    EXPECT_EQ(stats.chunks, 0);
+#endif
+}
+
+TEST(StatsTest, StreamCountsAcrossChunks) {
+    ReplaceStats stats;
+    StreamReplacer replacer(2, 'a', 'b', &stats);
+    EXPECT_EQ(replacer.process("a"), "a");
+    EXPECT_EQ(replacer.process("aaa"), "bab");
+#if REPLACER_STATS
+    EXPECT_EQ(stats.matches, 4);
+    EXPECT_EQ(stats.replacements, 2);
+    EXPECT_EQ(stats.chunks, 2);
+#endif
+}
+
+TEST(StatsTest, BatchAndJson) {
+    ReplaceStats stats;
+    std::FILE* in = std::tmpfile();
+    std::FILE* out = std::tmpfile();
+    std::string input = "aaa\n1 a b\nxyz\n3 x y\n";
+    std::fwrite(input.data(), 1, input.size(), in);
+    std::rewind(in);
+    ASSERT_TRUE(replace_batch(in, out, CounterMode::PerLine, &stats));
+    std::fclose(in);
+    std::fclose(out);
+#if REPLACER_STATS
+    EXPECT_EQ(stats.chunks, 2);
+    EXPECT_EQ(stats.matches, 4);
+    EXPECT_EQ(stats.replacements, 3);
+#endif
+
+    // записи с n <= 0 тоже считаются
+    stats = ReplaceStats();
+    in = std::tmpfile();
+    out = std::tmpfile();
+    input = "aaa\n0 a b\nxyz\n-1 x y\naa\n2 a c\n";
+    std::fwrite(input.data(), 1, input.size(), in);
+    std::rewind(in);
+    ASSERT_TRUE(replace_batch(in, out, CounterMode::Stream, &stats));
+    std::fclose(in);
+    std::fclose(out);
+#if REPLACER_STATS
+    EXPECT_EQ(stats.chunks, 3);
+    EXPECT_EQ(stats.bytes_scanned, 8);
+    EXPECT_EQ(stats.matches, 3 + 1 + 2);
+    EXPECT_EQ(stats.replacements, 1);
+#endif
+
+    ReplaceStats fixed{100, 10, 5, 2, 7};
+    EXPECT_EQ(fixed.to_json(), "{\"bytes_scanned\":100,\"matches\":10,\"replacements\":5,\"chunks\":2,\"nanoseconds\":7}");
+}
@@ -0,0 +1,388 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "limbs.hpp"
+#include "limbs_div.hpp"
+#include "limbs_mul.hpp"
+#include "money.hpp"
+#include "money_accumulator.hpp"
+#include "money_reduce.hpp"
+
+// Every heap allocation of the process goes through here, so a benchmark can
+// report how many allocations one operation makes
+namespace {
+
+std::atomic<uint64_t> allocations{0};
+
+void* allocate(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size > 0 ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+}
+
+void* operator new(size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](size_t size) {
+    return allocate(size);
+}
+
+// std::pmr::new_delete_resource() asks for an alignment
+void* operator new(size_t size, std::align_val_t) {
+    return allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+std::string digits_of(int64_t count, char first) {
+    std::string text(count, '7');
+    text[0] = first;
+    return text;
+}
+
+template <typename Fn>
+void run(benchmark::State& state, Fn fn) {
+    uint64_t before = allocations.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        fn();
+    }
+    uint64_t made = allocations.load(std::memory_order_relaxed) - before;
+    state.counters["allocs_per_op"] = benchmark::Counter(static_cast<double>(made), benchmark::Counter::kAvgIterations);
+}
+
+void BM_ConstructFromString(benchmark::State& state) {
+    std::string text = digits_of(state.range(0), '1');
+    run(state, [&] {
+        Money money(text);
+        benchmark::DoNotOptimize(money);
+    });
+}
+
+// Parsing into an existing amount, as a feed reader would: no exceptions and
+// no allocation once the buffer is large enough
+void BM_FromChars(benchmark::State& state) {
+    std::string text = digits_of(state.range(0), '1');
+    Money money;
+    run(state, [&] {
+        benchmark::DoNotOptimize(from_chars(text, money));
+    });
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+
+void BM_ToChars(benchmark::State& state) {
+    Money money(digits_of(state.range(0), '1'));
+    std::vector<char> buffer(money.GetLength());
+    run(state, [&] {
+        benchmark::DoNotOptimize(to_chars(buffer.data(), buffer.data() + buffer.size(), money));
+    });
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buffer.size()));
+}
+
+void BM_Copy(benchmark::State& state) {
+    Money source(digits_of(state.range(0), '1'));
+    run(state, [&] {
+        Money copy(source);
+        benchmark::DoNotOptimize(copy);
+    });
+}
+
+void BM_Add(benchmark::State& state) {
+    Money lhs(digits_of(state.range(0), '1'));
+    Money rhs(digits_of(state.range(0), '2'));
+    run(state, [&] {
+        benchmark::DoNotOptimize(lhs + rhs);
+    });
+}
+
+void BM_Sub(benchmark::State& state) {
+    Money lhs(digits_of(state.range(0), '2'));
+    Money rhs(digits_of(state.range(0), '1'));
+    run(state, [&] {
+        benchmark::DoNotOptimize(lhs - rhs);
+    });
+}
+
+void BM_AddAssign(benchmark::State& state) {
+    Money sum(digits_of(state.range(0), '1'));
+    Money item(digits_of(state.range(0), '2'));
+    run(state, [&] {
+        sum += item;
+        benchmark::DoNotOptimize(sum);
+    });
+}
+
+void BM_Compare(benchmark::State& state) {
+    Money lhs(digits_of(state.range(0), '1'));
+    Money rhs(digits_of(state.range(0), '2'));
+    run(state, [&] {
+        benchmark::DoNotOptimize(lhs < rhs);
+    });
+}
+
+void BM_Mul(benchmark::State& state) {
+    Money lhs(digits_of(state.range(0), '1'));
+    Money rhs(digits_of(state.range(0), '2'));
+    run(state, [&] {
+        benchmark::DoNotOptimize(lhs * rhs);
+    });
+}
+
+void BM_MulSmall(benchmark::State& state) {
+    Money value(digits_of(state.range(0), '1'));
+    run(state, [&] {
+        benchmark::DoNotOptimize(value * 12345);
+    });
+}
+
+// One algorithm on the top level; the crossovers of these curves are the
+// thresholds in limbs_mul.hpp
+void BM_MulLimbs(benchmark::State& state) {
+    auto algorithm = static_cast<MulAlgorithm>(state.range(0));
+    size_t n = state.range(1);
+    std::mt19937 gen(static_cast<unsigned>(n));
+    std::uniform_int_distribution<uint32_t> limb(0, 999999999);
+    std::vector<uint32_t> a(n), b(n), r(2 * n);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = limb(gen);
+        b[i] = limb(gen);
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(mul_limbs(algorithm, a.data(), n, b.data(), n, r.data()));
+        benchmark::ClobberMemory();
+    }
+}
+
+void BM_DivSmall(benchmark::State& state) {
+    Money value(digits_of(state.range(0), '1'));
+    run(state, [&] {
+        benchmark::DoNotOptimize(value / 7);
+    });
+}
+
+// Dividend of the given length by a divisor half as long
+void BM_Div(benchmark::State& state) {
+    Money lhs(digits_of(state.range(0), '9'));
+    Money rhs(digits_of((state.range(0) + 1) / 2, '3'));
+    run(state, [&] {
+        benchmark::DoNotOptimize(lhs / rhs);
+    });
+}
+
+// A ledger of amounts up to the given length, a third of them negative
+std::vector<Money> ledger_of(int64_t digits, size_t count) {
+    std::mt19937 gen(static_cast<unsigned>(digits));
+    std::uniform_int_distribution<int64_t> length(1, digits);
+    std::uniform_int_distribution<int> digit(0, 9);
+    std::vector<Money> ledger;
+    ledger.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::string text = i % 3 == 0 ? "-" : "";
+        for (int64_t n = length(gen); n > 0; --n) {
+            text.push_back(static_cast<char>('0' + digit(gen)));
+        }
+        ledger.emplace_back(text);
+    }
+    return ledger;
+}
+
+constexpr size_t LEDGER_SIZE = 1 << 20;
+
+// A report line by line into a stream that drops everything, so only the
+// formatting and the stream calls are measured
+void BM_Print(benchmark::State& state) {
+    struct Discard : std::streambuf {
+        std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+        int overflow(int c) override { return c; }
+    } discard;
+    std::ostream os(&discard);
+    std::vector<Money> ledger = ledger_of(state.range(0), 1024);
+    run(state, [&] {
+        for (const Money& m : ledger) {
+            os << m << '\n';
+        }
+    });
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ledger.size()));
+}
+
+void BM_SumAddAssign(benchmark::State& state) {
+    std::vector<Money> ledger = ledger_of(state.range(0), LEDGER_SIZE);
+    run(state, [&] {
+        Money total("0");
+        for (const Money& value : ledger) {
+            total += value;
+        }
+        benchmark::DoNotOptimize(total);
+    });
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ledger.size()));
+}
+
+void BM_SumAccumulator(benchmark::State& state) {
+    std::vector<Money> ledger = ledger_of(state.range(0), LEDGER_SIZE);
+    run(state, [&] {
+        MoneyAccumulator accumulator;
+        accumulator.add(std::span<const Money>(ledger));
+        benchmark::DoNotOptimize(accumulator.total());
+    });
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ledger.size()));
+}
+
+// Per-thread throughput shows whether scaling stops at memory bandwidth
+void BM_ParallelSum(benchmark::State& state) {
+    std::vector<Money> ledger = ledger_of(36, LEDGER_SIZE * 4);
+    auto threads = static_cast<unsigned>(state.range(0));
+    std::vector<ReduceThreadStats> stats;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parallel_sum(ledger, threads, &stats));
+    }
+    double slowest = 0;
+    double throughput = 0;
+    for (const ReduceThreadStats& thread : stats) {
+        slowest = std::max(slowest, thread.seconds);
+        throughput += thread.items_per_second();
+    }
+    state.counters["threads_run"] = static_cast<double>(stats.size());
+    state.counters["items_per_second_per_thread"] = throughput / static_cast<double>(stats.size());
+    state.counters["slowest_thread_ms"] = slowest * 1000;
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ledger.size()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * ledger.size() * sizeof(Money)));
+}
+
+// Products of heap-sized amounts, with temporaries from new/delete or, with
+// arena set, from a monotonic buffer released once per iteration. The arena
+// becomes the process-wide default, which is only safe here because the
+// benchmark runs on one thread.
+void BM_Temporaries(benchmark::State& state) {
+    bool arena = state.range(0) != 0;
+    std::vector<Money> ledger = ledger_of(state.range(1), 1024);
+    std::vector<std::byte> buffer(1 << 20);
+    run(state, [&] {
+        std::pmr::monotonic_buffer_resource pool(buffer.data(), buffer.size());
+        std::pmr::memory_resource* previous = arena ? std::pmr::set_default_resource(&pool) : nullptr;
+        Money total;
+        for (size_t i = 1; i < ledger.size(); ++i) {
+            total += ledger[i] * ledger[i - 1];
+        }
+        benchmark::DoNotOptimize(total);
+        if (arena) {
+            std::pmr::set_default_resource(previous);
+        }
+    });
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ledger.size()));
+}
+
+// Plain add/sub kernels over n limbs, scalar against SIMD
+void BM_AddLimbs(benchmark::State& state) {
+    auto isa = static_cast<LimbIsa>(state.range(0));
+    if (!limb_isa_supported(isa)) {
+        state.SkipWithError("instruction set is not supported");
+        return;
+    }
+    size_t n = state.range(1);
+    std::mt19937 gen(static_cast<unsigned>(n));
+    std::uniform_int_distribution<uint32_t> limb(0, 999999999);
+    std::vector<uint32_t> a(n), b(n), r(n);
+    for (auto& x : a) x = limb(gen);
+    for (auto& x : b) x = limb(gen);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(add_n(isa, a.data(), b.data(), n, r.data()));
+        benchmark::DoNotOptimize(sub_n(isa, r.data(), b.data(), n, r.data()));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * n * sizeof(uint32_t) * 2));
+}
+
+// 2n limbs by n limbs with one algorithm; where the curves cross is
+// NEWTON_THRESHOLD in limbs_div.hpp
+void BM_DivLimbs(benchmark::State& state) {
+    auto algorithm = static_cast<DivAlgorithm>(state.range(0));
+    size_t n = state.range(1);
+    std::mt19937 gen(static_cast<unsigned>(n));
+    std::uniform_int_distribution<uint32_t> limb(1, 999999999);
+    std::vector<uint32_t> a(2 * n), b(n), q(n + 1), r(n);
+    for (auto& x : a) x = limb(gen);
+    for (auto& x : b) x = limb(gen);
+    for (auto _ : state) {
+        divmod_limbs(algorithm, a.data(), a.size(), b.data(), b.size(), q.data(), r.data());
+        benchmark::DoNotOptimize(q.data());
+        benchmark::ClobberMemory();
+    }
+}
+
+// Typical ledger amounts fit the inline buffer (up to 36 digits), the last
+// sizes go to the heap
+void sizes(benchmark::internal::Benchmark* bench) {
+    bench->ArgName("digits")->Arg(5)->Arg(12)->Arg(27)->Arg(100)->Arg(1000);
+}
+
+}
+
+BENCHMARK(BM_ConstructFromString)->Apply(sizes);
+BENCHMARK(BM_FromChars)->Apply(sizes);
+BENCHMARK(BM_ToChars)->Apply(sizes);
+BENCHMARK(BM_Print)->ArgName("digits")->Arg(12)->Arg(36)->Arg(100);
+BENCHMARK(BM_Copy)->Apply(sizes);
+BENCHMARK(BM_Add)->Apply(sizes);
+BENCHMARK(BM_Sub)->Apply(sizes);
+BENCHMARK(BM_AddAssign)->Apply(sizes);
+BENCHMARK(BM_Compare)->Apply(sizes);
+BENCHMARK(BM_Mul)->Apply(sizes)->Arg(10000)->Arg(100000);
+BENCHMARK(BM_MulSmall)->Apply(sizes);
+BENCHMARK(BM_MulLimbs)
+    ->ArgsProduct({{static_cast<int64_t>(MulAlgorithm::Schoolbook), static_cast<int64_t>(MulAlgorithm::Karatsuba),
+                    static_cast<int64_t>(MulAlgorithm::Toom3), static_cast<int64_t>(MulAlgorithm::Ntt)},
+                   benchmark::CreateRange(16, 1 << 16, 2)})
+    ->ArgNames({"algorithm", "limbs"});
+BENCHMARK(BM_DivSmall)->Apply(sizes);
+BENCHMARK(BM_Div)->Apply(sizes)->Arg(10000)->Arg(100000);
+BENCHMARK(BM_SumAddAssign)->ArgName("digits")->Arg(12)->Arg(36)->Arg(100)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SumAccumulator)->ArgName("digits")->Arg(12)->Arg(36)->Arg(100)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ParallelSum)->ArgName("threads")->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Temporaries)->ArgNames({"arena", "digits"})->ArgsProduct({{0, 1}, {36, 100}});
+BENCHMARK(BM_AddLimbs)
+    ->ArgsProduct({{static_cast<int64_t>(LimbIsa::Scalar), static_cast<int64_t>(LimbIsa::Avx2)},
+                   benchmark::CreateRange(8, 1 << 16, 8)})
+    ->ArgNames({"isa", "limbs"});
+BENCHMARK(BM_DivLimbs)
+    ->ArgsProduct({{static_cast<int64_t>(DivAlgorithm::Long), static_cast<int64_t>(DivAlgorithm::Newton)},
+                   benchmark::CreateRange(16, 1 << 14, 2)})
+    ->ArgNames({"algorithm", "limbs"});
+
+BENCHMARK_MAIN();
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Helpers on unsigned numbers stored as base 10^9 limbs, least significant
+// first. Sizes are in limbs; a normalized number has no zero limbs on top.
+constexpr uint32_t LIMB_BASE = 1'000'000'000;
+constexpr size_t LIMB_DIGITS = 9;
+
+// Drops zero limbs on top, returns the new size
+size_t normalize_limbs(const uint32_t* a, size_t an);
+
+// -1, 0 or 1 as a is less, equal or greater than b (both normalized)
+int compare_limbs(const uint32_t* a, size_t an, const uint32_t* b, size_t bn);
+
+// Instruction sets the add/sub kernels below have versions for
+enum class LimbIsa {
+    Scalar,
+    Avx2,
+};
+
+bool limb_isa_supported(LimbIsa isa);
+
+// r = a + b over n limbs each, returns the carry out (0 or 1); r may be a or
+// b. The AVX2 version adds eight limbs at a time and resolves carries inside
+// the block with a carry-lookahead on lane bitmasks.
+uint32_t add_n(const uint32_t* a, const uint32_t* b, size_t n, uint32_t* r);
+uint32_t add_n(LimbIsa isa, const uint32_t* a, const uint32_t* b, size_t n, uint32_t* r);
+
+// r = a - b over n limbs each, returns the borrow out (0 or 1); r may be a or b
+uint32_t sub_n(const uint32_t* a, const uint32_t* b, size_t n, uint32_t* r);
+uint32_t sub_n(LimbIsa isa, const uint32_t* a, const uint32_t* b, size_t n, uint32_t* r);
+
+// r = a + b; r must hold max(an, bn) + 1 limbs and may be a or b.
+// Returns the size of r.
+size_t add_limbs(const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* r);
+
+// a += b in place for an >= bn; a has an limbs. Returns the carry out of
+// the top limb (0 or 1).
+uint32_t add_limbs_inplace(uint32_t* a, size_t an, const uint32_t* b, size_t bn);
+
+// r = a - b for a >= b; r must hold an limbs and may be a or b.
+// Returns the normalized size of r.
+size_t sub_limbs(const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* r);
+
+// Decimal digits of a normalized number, 0 has none
+size_t count_digits(const uint32_t* a, size_t an);
+
+// First character of [first, last) that is not a decimal digit, or last. The
+// AVX2 version checks 32 characters at a time, then 16.
+const char* find_non_digit(const char* first, const char* last);
+const char* find_non_digit(LimbIsa isa, const char* first, const char* last);
+
+// Parses decimal digits [first, last) into r, which must hold
+// (last - first + 8) / 9 limbs. Returns the normalized size.
+size_t parse_limbs(const char* first, const char* last, uint32_t* r);
+
+// Writes the count_digits(a, an) decimal digits of a normalized number at out
+// and returns the end; two digits at a time from a table
+char* format_limbs(const uint32_t* a, size_t an, char* out);
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Division of base 10^9 limb numbers (see limbs.hpp)
+
+// Divisor that fits in 32 bits, with its reciprocal computed once: every limb
+// then costs a multiplication instead of a hardware division
+struct LimbDivisor {
+    uint32_t d;
+    uint64_t reciprocal;
+
+    explicit LimbDivisor(uint32_t d);
+};
+
+// q = a / d, returns a % d; q must hold an limbs and may be a
+uint32_t div_limb(const uint32_t* a, size_t an, const LimbDivisor& d, uint32_t* q);
+
+enum class DivAlgorithm {
+    Long,
+    Newton,
+};
+
+// Once both the divisor and the quotient have this many limbs, division goes
+// through a Newton reciprocal; the threshold comes from BM_DivLimbs in
+// bench/bench_money.cpp
+constexpr size_t NEWTON_THRESHOLD = 150;
+
+// q = a / b and r = a % b for a normalized b with bn > 0. q must hold
+// an - bn + 1 limbs (an >= bn) and r must hold bn limbs, neither may overlap
+// a or b. Both are written in full, normalize them with normalize_limbs.
+void divmod_limbs(const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* q, uint32_t* r);
+
+// Same with the algorithm forced, meant for tests and benchmarks
+void divmod_limbs(DivAlgorithm algorithm, const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* q, uint32_t* r);
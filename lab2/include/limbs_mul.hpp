@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Multiplication of base 10^9 limb numbers (see limbs.hpp). mul_limbs picks
+// the algorithm by the size of the shorter operand; the thresholds below are
+// in limbs and come from BM_MulLimbs in bench/bench_money.cpp.
+enum class MulAlgorithm {
+    Schoolbook,
+    Karatsuba,
+    Toom3,
+    Ntt,
+};
+
+constexpr size_t KARATSUBA_THRESHOLD = 24;
+constexpr size_t TOOM3_THRESHOLD = 200;
+// The NTT pads to a power of two, so it only pulls ahead of Toom-3 once the
+// padding is small next to the work saved
+constexpr size_t NTT_THRESHOLD = 16384;
+
+// r = a * b; r must hold an + bn limbs and must not overlap a or b.
+// Returns the normalized size of r.
+size_t mul_limbs(const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* r);
+
+// Same, with algorithm used on the top level whatever the sizes are (Ntt falls
+// back to Toom3 past its maximum length); recursive steps are chosen as usual.
+// Meant for tests and benchmarks.
+size_t mul_limbs(MulAlgorithm algorithm, const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* r);
+
+// a *= m in place for m < LIMB_BASE. Returns the limb carried out of the top
+// (0 if nothing is left).
+uint32_t mul_limb_inplace(uint32_t* a, size_t an, uint32_t m);
@@ -1,47 +1,165 @@
 #pragma once
 
+#include <charconv>
+#include <compare>
+#include <cstdint>
+#include <initializer_list>
+#include <memory_resource>
+#include <ostream>
 #include <string>
-
-
+#include <string_view>
+#include <vector>
+
+
+// Whole amount of any length. The absolute value is kept in base 10^9 limbs
+// (see limbs.hpp), so arithmetic and comparison work nine digits at a time.
+// Amounts up to INLINE_LIMBS limbs (36 digits) live inside the object and
+// need no heap allocation.
+//
+// Larger amounts take their blocks from a std::pmr::memory_resource, by
+// default std::pmr::get_default_resource(). As with pmr containers, a copy
+// gets the default resource and a move keeps the source one, so a batch job
+// can set a monotonic arena as the default and drop all temporaries at once.
+// The default resource is shared by the whole process and
+// monotonic_buffer_resource is not thread-safe: do this only while no other
+// thread creates amounts (parallel_sum and parallel_transform_reduce
+// workers do). Otherwise give each thread its own arena through the
+// constructors that take a resource, or make the default a
+// synchronized_pool_resource.
 class Money {
     friend Money operator+(const Money& lhs, const Money& rhs);
+    friend Money operator+(Money&& lhs, const Money& rhs);
 
     friend Money operator-(const Money& lhs, const Money& rhs);
-
+    friend Money operator-(Money&& lhs, const Money& rhs);
+
+    // Algorithm is picked by operand size, see limbs_mul.hpp
+    friend Money operator*(const Money& lhs, const Money& rhs);
+    friend Money operator*(const Money& lhs, int64_t rhs);
+    friend Money operator*(int64_t lhs, const Money& rhs);
+
+    // Truncate toward zero, the remainder takes the sign of lhs. A zero
+    // divisor throws std::invalid_argument.
+    friend Money operator/(const Money& lhs, const Money& rhs);
+    friend Money operator/(const Money& lhs, int64_t rhs);
+    friend Money operator%(const Money& lhs, const Money& rhs);
+    friend Money operator%(const Money& lhs, int64_t rhs);
+
+    // Formatted output of what to_chars gives, straight into os.rdbuf():
+    // padded to os.width() with os.fill() by the adjustfield flags, the width
+    // is reset afterwards, and a short write sets badbit
     friend std::ostream& operator<<(std::ostream& os, const Money& m);
 
+    // Writes GetLength() characters into [first, last) the way std::to_chars
+    // does: ptr is the end of the text, or last with
+    // std::errc::value_too_large if it does not fit. With a separator, digits
+    // are grouped by three from the right ("-1,234,567").
+    friend std::to_chars_result to_chars(char* first, char* last, const Money& value);
+    friend std::to_chars_result to_chars(char* first, char* last, const Money& value, char separator);
+
+    // Parses an optional '-' or '+' and decimal digits the way std::from_chars
+    // does: ptr ends up past the last digit, and without digits ec is
+    // std::errc::invalid_argument and value is left alone. Digits are checked
+    // with SIMD and parsed straight into the limbs of value.
+    friend std::from_chars_result from_chars(const char* first, const char* last, Money& value);
+
+    friend class MoneyAccumulator;
+
 public:
+    static constexpr size_t INLINE_LIMBS = 4;
+
     Money();
+    explicit Money(std::pmr::memory_resource* resource);
 
     Money(size_t n, unsigned char t = 0);
     Money(const Money& other);
+    Money(const Money& other, std::pmr::memory_resource* resource);
 
     Money(const std::initializer_list<unsigned char>& t);
 
+    // The whole string must parse with from_chars and must not start with
+    // '+', else std::invalid_argument
     Money(const std::string& other);
+    Money(const std::string& other, std::pmr::memory_resource* resource);
 
+    // Assignment keeps the resource of *this; a move between different
+    // resources copies
     Money& operator=(const Money& other);
 
-    Money& operator=(Money&& other) noexcept;
+    Money& operator=(Money&& other);
 
     Money(Money&& other) noexcept;
 
+    // In place: the buffer grows only when a carry spills over its capacity
+    Money& operator+=(const Money& other);
+    Money& operator-=(const Money& other);
+
+    Money& operator*=(const Money& other);
+    // Works in place when |factor| fits one limb
+    Money& operator*=(int64_t factor);
+
+    Money& operator/=(const Money& other);
+    // Works in place when |divisor| fits 32 bits
+    Money& operator/=(int64_t divisor);
+    Money& operator%=(const Money& other);
+    Money& operator%=(int64_t divisor);
+
+    // Splits the amount into parts shares that add up to it exactly. Shares
+    // differ by at most one unit, the ones further from zero come first.
+    std::vector<Money> allocate(size_t parts) const;
+
+    // By value: sign, then limb count, then limbs from the top. Leading zeros
+    // and the sign of zero do not matter, so the ordering is weak: "007" and
+    // "7" are equivalent but print differently.
+    std::weak_ordering operator<=>(const Money& other) const;
     bool operator==(const Money& other) const;
-    bool operator!=(const Money& other) const;
-    bool operator>(const Money& other) const;
-    bool operator>=(const Money& other) const;
-    bool operator<(const Money& other) const;
-    bool operator<=(const Money& other) const;
 
+    // Characters printed by operator<<: sign and digits, leading zeros included
     size_t GetLength() const;
 
+    std::pmr::memory_resource* get_resource() const;
+
     virtual ~Money() noexcept;
 
 private:
-    unsigned char* data;
+    // points to local or to a heap block of capacity limbs
+    uint32_t* data;
     size_t size;
+    size_t capacity;
+    // printed digits; more than the value has if it was given with leading zeros
+    size_t digits;
+    bool negative;
+    std::pmr::memory_resource* resource;
+    uint32_t local[INLINE_LIMBS];
+
+    bool is_inline() const;
+
+    // Makes room for limbs limbs, the current value is kept
+    void reserve(size_t limbs);
 
+    // Exchanges everything, resources included
     void swap(Money& other) noexcept;
+
+    // Moves the value of other into *this without changing the resource:
+    // swaps when both share it and copies otherwise
+    void take(Money& other);
+
+    // Takes the decimal digits [first, last); they must be valid
+    void assign_digits(const char* first, const char* last);
+
+    // Recomputes digits and the sign of zero after arithmetic
+    void normalize();
+
+    // -1, 0 or 1 as the value is below, equal to or above other's
+    int compare(const Money& other) const;
+
+    // *this += other, or -= when subtract is set
+    void add(const Money& other, bool subtract);
+
+    static Money of(int64_t value);
+
+    // Either output may be null
+    static void divide(const Money& lhs, const Money& rhs, Money* quotient, Money* remainder);
 };
 
-int32_t stoi(const unsigned char* data, size_t size);
+std::from_chars_result from_chars(std::string_view text, Money& value);
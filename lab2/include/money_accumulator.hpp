@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "money.hpp"
+
+// Sum of many amounts with deferred carries. Limbs of every amount are added
+// into 64-bit lanes as they are, one lane per limb position and separate
+// lanes for positive and negative amounts. Carries are resolved only by
+// total() or when a lane could overflow, so adding an amount is a plain
+// vectorizable loop with no allocation once the lanes are wide enough.
+class MoneyAccumulator {
+public:
+    // A lane below LIMB_BASE can take this many more limbs without overflow
+    static constexpr uint64_t MAX_PENDING = UINT64_MAX / 1'000'000'000 - 1;
+
+    // Lanes are settled once max_pending additions are waiting (clamped to
+    // [1, MAX_PENDING]); a lower limit only exists to exercise that path
+    explicit MoneyAccumulator(uint64_t max_pending = MAX_PENDING);
+
+    MoneyAccumulator& add(const Money& value);
+    MoneyAccumulator& add(std::span<const Money> values);
+
+    template <typename It>
+    MoneyAccumulator& add(It first, It last) {
+        for (; first != last; ++first) {
+            add(*first);
+        }
+        return *this;
+    }
+
+    // Merges the lanes of other in, as if its amounts were added here
+    MoneyAccumulator& merge(const MoneyAccumulator& other);
+
+    Money total() const;
+
+    void reset();
+
+private:
+    std::vector<uint64_t> positive;
+    std::vector<uint64_t> negative;
+    uint64_t pending = 0;
+    uint64_t max_pending;
+
+    // Carries every lane into the next one, all lanes end up below LIMB_BASE
+    static void settle(std::vector<uint64_t>& lanes);
+
+    void settle_if_full(uint64_t incoming);
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "money.hpp"
+#include "money_accumulator.hpp"
+
+// Work of one thread in a parallel reduction
+struct ReduceThreadStats {
+    size_t items = 0;
+    double seconds = 0;
+
+    double items_per_second() const;
+};
+
+// Splits [0, count) into one chunk per thread, every thread fills its own
+// accumulator through work(first, last, accumulator), then the accumulators
+// are merged pairwise in a tree. threads == 0 means hardware_concurrency().
+// If stats is given it gets one entry per thread that ran. An exception from
+// work is rethrown once all threads have joined; if several threads throw,
+// the one with the lowest chunk wins.
+Money reduce_chunks(size_t count, unsigned threads,
+                    const std::function<void(size_t, size_t, MoneyAccumulator&)>& work,
+                    std::vector<ReduceThreadStats>* stats = nullptr);
+
+// Sum of values on several threads. Money sums are exact, so the result does
+// not depend on the thread count or the merge order.
+Money parallel_sum(std::span<const Money> values, unsigned threads = 0, std::vector<ReduceThreadStats>* stats = nullptr);
+
+// Sum of transform(value) over values; transform returns a Money
+template <typename T, typename Transform>
+Money parallel_transform_reduce(std::span<const T> values, Transform transform, unsigned threads = 0,
+                                std::vector<ReduceThreadStats>* stats = nullptr) {
+    return reduce_chunks(
+        values.size(), threads,
+        [&](size_t first, size_t last, MoneyAccumulator& accumulator) {
+            for (size_t i = first; i < last; ++i) {
+                accumulator.add(transform(values[i]));
+            }
+        },
+        stats);
+}
+
+// Same for a vector, which the span overload cannot deduce T from
+template <typename T, typename Transform>
+Money parallel_transform_reduce(const std::vector<T>& values, Transform transform, unsigned threads = 0,
+                                std::vector<ReduceThreadStats>* stats = nullptr) {
+    return parallel_transform_reduce(std::span<const T>(values), std::move(transform), threads, stats);
+}
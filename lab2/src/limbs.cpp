@@ -0,0 +1,354 @@
+#include "limbs.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define LIMBS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using AddKernel = uint32_t (*)(const uint32_t*, const uint32_t*, size_t, uint32_t*);
+using ScanKernel = const char* (*)(const char*, const char*);
+
+// Shorter runs than this go to the scalar loop directly
+constexpr size_t SIMD_MIN_LIMBS = 8;
+
+uint32_t add_n_scalar(const uint32_t* a, const uint32_t* b, size_t n, uint32_t* r) {
+    uint32_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t sum = a[i] + b[i] + carry;
+        carry = sum >= LIMB_BASE;
+        r[i] = carry ? sum - LIMB_BASE : sum;
+    }
+    return carry;
+}
+
+uint32_t sub_n_scalar(const uint32_t* a, const uint32_t* b, size_t n, uint32_t* r) {
+    uint32_t borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t sub = b[i] + borrow;
+        borrow = a[i] < sub;
+        r[i] = borrow ? a[i] + LIMB_BASE - sub : a[i] - sub;
+    }
+    return borrow;
+}
+
+const char* find_non_digit_scalar(const char* first, const char* last) {
+    while (first != last && static_cast<unsigned char>(*first - '0') <= 9) {
+        ++first;
+    }
+    return first;
+}
+
+#ifdef LIMBS_X86
+
+// Lane i of the block gets a carry if lane i - 1 generates one, or if it
+// propagates (its sum is exactly 999999999) and gets one itself. With g and p
+// as lane bitmasks, adding the generated carries to p runs each of them
+// through its chain of propagating lanes, and xor with p leaves the carry
+// into every lane; bit 8 is the carry out of the block.
+inline uint32_t lookahead(uint32_t g, uint32_t p, uint32_t carry) {
+    return (((g << 1) | carry) + p) ^ p;
+}
+
+__attribute__((target("avx2")))
+inline __m256i lane_bits(uint32_t mask) {
+    const __m256i shifts = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    return _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(static_cast<int>(mask)), shifts), _mm256_set1_epi32(1));
+}
+
+__attribute__((target("avx2")))
+uint32_t add_n_avx2(const uint32_t* a, const uint32_t* b, size_t n, uint32_t* r) {
+    const __m256i base = _mm256_set1_epi32(LIMB_BASE);
+    const __m256i top = _mm256_set1_epi32(LIMB_BASE - 1);
+    uint32_t carry = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        // sums are below 2 * 10^9 and compare fine as signed
+        __m256i sum = _mm256_add_epi32(va, vb);
+        auto g = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(sum, top))));
+        auto p = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(sum, top))));
+        uint32_t c = lookahead(g, p, carry);
+        sum = _mm256_add_epi32(sum, lane_bits(c));
+        // sum - base wraps to a huge value unless sum >= base
+        sum = _mm256_min_epu32(sum, _mm256_sub_epi32(sum, base));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), sum);
+        carry = c >> 8;
+    }
+    for (; i < n; ++i) {
+        uint32_t sum = a[i] + b[i] + carry;
+        carry = sum >= LIMB_BASE;
+        r[i] = carry ? sum - LIMB_BASE : sum;
+    }
+    return carry;
+}
+
+// Same scheme for borrows: a lane generates one when a < b and propagates
+// one when a == b
+__attribute__((target("avx2")))
+uint32_t sub_n_avx2(const uint32_t* a, const uint32_t* b, size_t n, uint32_t* r) {
+    const __m256i base = _mm256_set1_epi32(LIMB_BASE);
+    uint32_t borrow = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        auto g = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(vb, va))));
+        auto p = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(va, vb))));
+        uint32_t c = lookahead(g, p, borrow);
+        __m256i diff = _mm256_sub_epi32(_mm256_sub_epi32(va, vb), lane_bits(c));
+        // negative lanes get base back
+        diff = _mm256_add_epi32(diff, _mm256_and_si256(_mm256_srai_epi32(diff, 31), base));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), diff);
+        borrow = c >> 8;
+    }
+    for (; i < n; ++i) {
+        uint32_t sub = b[i] + borrow;
+        borrow = a[i] < sub;
+        r[i] = borrow ? a[i] + LIMB_BASE - sub : a[i] - sub;
+    }
+    return borrow;
+}
+
+// A character is a digit when c - '0' is at most 9 as an unsigned byte, that
+// is when max(c - '0', 9) is 9
+__attribute__((target("avx2")))
+const char* find_non_digit_avx2(const char* first, const char* last) {
+    const __m256i zero = _mm256_set1_epi8('0');
+    const __m256i nine = _mm256_set1_epi8(9);
+    for (; last - first >= 32; first += 32) {
+        __m256i v = _mm256_sub_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(first)), zero);
+        auto digits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(v, nine), nine)));
+        if (digits != UINT32_MAX) {
+            return first + std::countr_one(digits);
+        }
+    }
+    if (last - first >= 16) {
+        __m128i v = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first)), _mm_set1_epi8('0'));
+        __m128i nine16 = _mm_set1_epi8(9);
+        auto digits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, nine16), nine16)));
+        if (digits != 0xFFFF) {
+            return first + std::countr_one(digits);
+        }
+        first += 16;
+    }
+    return find_non_digit_scalar(first, last);
+}
+
+#endif
+
+ScanKernel scan_kernel_for(LimbIsa isa) {
+#ifdef LIMBS_X86
+    if (isa == LimbIsa::Avx2) {
+        return find_non_digit_avx2;
+    }
+#endif
+    return find_non_digit_scalar;
+}
+
+// Eight digits at once: neighbouring digits, then pairs, then quads are
+// combined inside one 64-bit word
+uint32_t parse_eight(const char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    v -= 0x3030303030303030;
+    v = v * 10 + (v >> 8);
+    v = ((v & 0x000000FF000000FF) * (100 + (1000000ULL << 32)) + ((v >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32))) >> 32;
+    return static_cast<uint32_t>(v);
+}
+
+constexpr char DIGIT_PAIRS[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// Writes the last count digits of value backwards, ending at end
+void format_backwards(uint32_t value, size_t count, char* end) {
+    for (; count >= 2; count -= 2) {
+        end -= 2;
+        std::memcpy(end, DIGIT_PAIRS + 2 * (value % 100), 2);
+        value /= 100;
+    }
+    if (count > 0) {
+        *--end = static_cast<char>('0' + value % 10);
+    }
+}
+
+AddKernel add_kernel_for(LimbIsa isa) {
+#ifdef LIMBS_X86
+    if (isa == LimbIsa::Avx2) {
+        return add_n_avx2;
+    }
+#endif
+    return add_n_scalar;
+}
+
+AddKernel sub_kernel_for(LimbIsa isa) {
+#ifdef LIMBS_X86
+    if (isa == LimbIsa::Avx2) {
+        return sub_n_avx2;
+    }
+#endif
+    return sub_n_scalar;
+}
+
+LimbIsa best_isa() {
+    static const LimbIsa isa = limb_isa_supported(LimbIsa::Avx2) ? LimbIsa::Avx2 : LimbIsa::Scalar;
+    return isa;
+}
+
+}
+
+bool limb_isa_supported(LimbIsa isa) {
+    switch (isa) {
+#ifdef LIMBS_X86
+        case LimbIsa::Avx2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        case LimbIsa::Scalar:
+            return true;
+        default:
+            return false;
+    }
+}
+
+uint32_t add_n(const uint32_t* a, const uint32_t* b, size_t n, uint32_t* r) {
+    static const AddKernel kernel = add_kernel_for(best_isa());
+    return n < SIMD_MIN_LIMBS ? add_n_scalar(a, b, n, r) : kernel(a, b, n, r);
+}
+
+uint32_t add_n(LimbIsa isa, const uint32_t* a, const uint32_t* b, size_t n, uint32_t* r) {
+    return add_kernel_for(isa)(a, b, n, r);
+}
+
+uint32_t sub_n(const uint32_t* a, const uint32_t* b, size_t n, uint32_t* r) {
+    static const AddKernel kernel = sub_kernel_for(best_isa());
+    return n < SIMD_MIN_LIMBS ? sub_n_scalar(a, b, n, r) : kernel(a, b, n, r);
+}
+
+uint32_t sub_n(LimbIsa isa, const uint32_t* a, const uint32_t* b, size_t n, uint32_t* r) {
+    return sub_kernel_for(isa)(a, b, n, r);
+}
+
+const char* find_non_digit(const char* first, const char* last) {
+    static const ScanKernel kernel = scan_kernel_for(best_isa());
+    return last - first < 16 ? find_non_digit_scalar(first, last) : kernel(first, last);
+}
+
+const char* find_non_digit(LimbIsa isa, const char* first, const char* last) {
+    return scan_kernel_for(isa)(first, last);
+}
+
+size_t normalize_limbs(const uint32_t* a, size_t an) {
+    while (an > 0 && a[an - 1] == 0) {
+        --an;
+    }
+    return an;
+}
+
+int compare_limbs(const uint32_t* a, size_t an, const uint32_t* b, size_t bn) {
+    if (an != bn) {
+        return an < bn ? -1 : 1;
+    }
+    for (size_t i = an; i-- > 0;) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+size_t add_limbs(const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* r) {
+    if (an < bn) {
+        return add_limbs(b, bn, a, an, r);
+    }
+    uint32_t carry = add_n(a, b, bn, r);
+    for (size_t i = bn; i < an; ++i) {
+        uint32_t sum = a[i] + carry;
+        carry = sum == LIMB_BASE;
+        r[i] = carry ? 0 : sum;
+    }
+    if (carry) {
+        r[an++] = carry;
+    }
+    return an;
+}
+
+uint32_t add_limbs_inplace(uint32_t* a, size_t an, const uint32_t* b, size_t bn) {
+    uint32_t carry = add_n(a, b, bn, a);
+    // the carry stops at the first limb that is not 999999999
+    for (size_t i = bn; carry && i < an; ++i) {
+        carry = a[i] == LIMB_BASE - 1;
+        a[i] = carry ? 0 : a[i] + 1;
+    }
+    return carry;
+}
+
+size_t sub_limbs(const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* r) {
+    bn = std::min(an, bn);
+    uint32_t borrow = sub_n(a, b, bn, r);
+    for (size_t i = bn; i < an; ++i) {
+        uint32_t value = a[i];
+        r[i] = value < borrow ? LIMB_BASE - 1 : value - borrow;
+        borrow = value < borrow;
+    }
+    return normalize_limbs(r, an);
+}
+
+size_t count_digits(const uint32_t* a, size_t an) {
+    if (an == 0) {
+        return 0;
+    }
+    size_t result = (an - 1) * LIMB_DIGITS;
+    for (uint32_t top = a[an - 1]; top > 0; top /= 10) {
+        ++result;
+    }
+    return result;
+}
+
+size_t parse_limbs(const char* first, const char* last, uint32_t* r) {
+    size_t an = 0;
+    // nine digits per limb starting from the least significant end
+    while (last != first) {
+        const char* chunk = last - first > static_cast<ptrdiff_t>(LIMB_DIGITS) ? last - LIMB_DIGITS : first;
+        uint32_t limb = 0;
+        if (std::endian::native == std::endian::little && last - chunk == static_cast<ptrdiff_t>(LIMB_DIGITS)) {
+            limb = static_cast<uint32_t>(*chunk - '0') * 100'000'000 + parse_eight(chunk + 1);
+        } else {
+            for (const char* p = chunk; p != last; ++p) {
+                limb = limb * 10 + static_cast<uint32_t>(*p - '0');
+            }
+        }
+        r[an++] = limb;
+        last = chunk;
+    }
+    return normalize_limbs(r, an);
+}
+
+char* format_limbs(const uint32_t* a, size_t an, char* out) {
+    if (an == 0) {
+        return out;
+    }
+    size_t top = count_digits(a + an - 1, 1);
+    out += top;
+    format_backwards(a[an - 1], top, out);
+    // lower limbs keep their leading zeros
+    for (size_t i = an - 1; i-- > 0;) {
+        out += LIMB_DIGITS;
+        format_backwards(a[i], LIMB_DIGITS, out);
+    }
+    return out;
+}
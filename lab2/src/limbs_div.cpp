@@ -0,0 +1,228 @@
+#include "limbs_div.hpp"
+#include "limbs.hpp"
+#include "limbs_mul.hpp"
+
+#include <algorithm>
+#include <vector>
+
+LimbDivisor::LimbDivisor(uint32_t d): d(d), reciprocal(UINT64_MAX / d) {}
+
+uint32_t div_limb(const uint32_t* a, size_t an, const LimbDivisor& d, uint32_t* q) {
+    uint64_t rem = 0;
+    for (size_t i = an; i-- > 0;) {
+        uint64_t cur = rem * LIMB_BASE + a[i];
+        // the estimate is at most two short
+        uint64_t quot = static_cast<uint64_t>((static_cast<unsigned __int128>(cur) * d.reciprocal) >> 64);
+        rem = cur - quot * d.d;
+        while (rem >= d.d) {
+            ++quot;
+            rem -= d.d;
+        }
+        q[i] = static_cast<uint32_t>(quot);
+    }
+    return static_cast<uint32_t>(rem);
+}
+
+namespace {
+
+using Limbs = std::vector<uint32_t>;
+
+// Both operands are multiplied by the same factor so that the top limb of the
+// divisor is at least LIMB_BASE / 2, then quotient digits are guessed well
+uint32_t normalizing_factor(const uint32_t* b, size_t bn) {
+    return LIMB_BASE / (b[bn - 1] + 1);
+}
+
+// Returns a * f in an + 1 limbs
+Limbs scaled(const uint32_t* a, size_t an, uint32_t f) {
+    Limbs u(a, a + an);
+    u.push_back(mul_limb_inplace(u.data(), an, f));
+    return u;
+}
+
+// Knuth's algorithm D. v has n >= 2 limbs with the top one at least
+// LIMB_BASE / 2, u has un > n limbs and u < v * LIMB_BASE^(un - n).
+// q gets un - n limbs, the remainder is left in u[0, n).
+void divide_normalized(uint32_t* u, size_t un, const uint32_t* v, size_t n, uint32_t* q) {
+    uint64_t top = v[n - 1];
+    uint64_t next = v[n - 2];
+    for (size_t j = un - n; j-- > 0;) {
+        uint64_t num = uint64_t{u[j + n]} * LIMB_BASE + u[j + n - 1];
+        uint64_t qhat = num / top;
+        uint64_t rhat = num % top;
+        while (qhat >= LIMB_BASE || qhat * next > rhat * LIMB_BASE + u[j + n - 2]) {
+            --qhat;
+            rhat += top;
+            if (rhat >= LIMB_BASE) {
+                break;
+            }
+        }
+        // u[j, j + n] -= qhat * v
+        uint64_t carry = 0;
+        uint32_t borrow = 0;
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t p = qhat * v[i] + carry;
+            carry = p / LIMB_BASE;
+            uint32_t sub = static_cast<uint32_t>(p % LIMB_BASE) + borrow;
+            borrow = u[i + j] < sub;
+            u[i + j] = borrow ? u[i + j] + LIMB_BASE - sub : u[i + j] - sub;
+        }
+        uint64_t sub = carry + borrow;
+        if (u[j + n] < sub) {
+            // qhat was one too big, add v back; the top limb ends up 0
+            --qhat;
+            uint32_t back = add_limbs_inplace(u + j, n, v, n);
+            u[j + n] = static_cast<uint32_t>(u[j + n] + back - sub);
+        } else {
+            u[j + n] -= static_cast<uint32_t>(sub);
+        }
+        q[j] = static_cast<uint32_t>(qhat);
+    }
+}
+
+void divmod_long(const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* q, uint32_t* r) {
+    if (bn == 1) {
+        r[0] = div_limb(a, an, LimbDivisor(b[0]), q);
+        return;
+    }
+    uint32_t f = normalizing_factor(b, bn);
+    Limbs u = scaled(a, an, f);
+    Limbs v = scaled(b, bn, f);
+    divide_normalized(u.data(), an + 1, v.data(), bn, q);
+    div_limb(u.data(), bn, LimbDivisor(f), r);
+}
+
+// Normalized numbers as vectors for the Newton steps
+
+Limbs product(const Limbs& x, const Limbs& y) {
+    Limbs result(x.size() + y.size());
+    result.resize(mul_limbs(x.data(), x.size(), y.data(), y.size(), result.data()));
+    return result;
+}
+
+// x * LIMB_BASE^k
+Limbs shift_up(Limbs x, size_t k) {
+    if (!x.empty()) {
+        x.insert(x.begin(), k, 0);
+    }
+    return x;
+}
+
+// x / LIMB_BASE^k
+Limbs shift_down(Limbs x, size_t k) {
+    x.erase(x.begin(), x.begin() + std::min(k, x.size()));
+    return x;
+}
+
+void add_to(Limbs& x, const Limbs& y) {
+    size_t xn = x.size();
+    x.resize(std::max(xn, y.size()) + 1);
+    x.resize(add_limbs(x.data(), xn, y.data(), y.size(), x.data()));
+}
+
+// x >= y
+void sub_from(Limbs& x, const Limbs& y) {
+    x.resize(sub_limbs(x.data(), x.size(), y.data(), y.size(), x.data()));
+}
+
+int compare(const Limbs& x, const Limbs& y) {
+    return compare_limbs(x.data(), x.size(), y.data(), y.size());
+}
+
+Limbs power(size_t k) {
+    Limbs result(k + 1, 0);
+    result[k] = 1;
+    return result;
+}
+
+constexpr size_t RECIPROCAL_BASE = 16;
+
+// About LIMB_BASE^(2n) / v, off by a few units, for v of n limbs with the top
+// one at least LIMB_BASE / 2. The reciprocal of the top half is refined by
+// one Newton step x + x * (B^2n - v * x) / B^2n, so precision doubles on
+// every level and the whole costs a few multiplications of n limbs.
+Limbs reciprocal(const uint32_t* v, size_t n) {
+    if (n <= RECIPROCAL_BASE) {
+        Limbs one = power(2 * n);
+        Limbs q(n + 2);
+        Limbs r(n);
+        divmod_long(one.data(), one.size(), v, n, q.data(), r.data());
+        q.resize(normalize_limbs(q.data(), q.size()));
+        return q;
+    }
+    // two limbs over half keep the error of xh, squared by the step, below
+    // one unit of x
+    size_t h = n / 2 + 2;
+    Limbs xh = reciprocal(v + n - h, h);
+    Limbs vn(v, v + normalize_limbs(v, n));
+    // x = xh * B^(n - h); the correction is x * e / B^2n = xh * e / B^(n + h)
+    Limbs vx = shift_up(product(vn, xh), n - h);
+    Limbs one = power(2 * n);
+    Limbs x = shift_up(xh, n - h);
+    if (compare(vx, one) <= 0) {
+        sub_from(one, vx);
+        add_to(x, shift_down(product(xh, one), n + h));
+    } else {
+        sub_from(vx, one);
+        sub_from(x, shift_down(product(xh, vx), n + h));
+    }
+    return x;
+}
+
+// Splits the dividend into pieces of n limbs and gets every quotient piece
+// by one multiplication with the reciprocal, fixed up by the remainder
+void divmod_newton(const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* q, uint32_t* r) {
+    uint32_t f = normalizing_factor(b, bn);
+    Limbs u = scaled(a, an, f);
+    Limbs v = scaled(b, bn, f);
+    v.resize(normalize_limbs(v.data(), v.size()));
+    size_t n = bn;
+    size_t un = normalize_limbs(u.data(), u.size());
+    Limbs x = reciprocal(v.data(), n);
+
+    size_t qn = an - bn + 1;
+    std::fill(q, q + qn, 0);
+    Limbs rem;
+    for (size_t c = (un + n - 1) / n; c-- > 0;) {
+        // cur = rem * B^n + u[c * n, c * n + n) < v * B^n
+        size_t from = c * n;
+        Limbs cur = shift_up(rem, n);
+        cur.resize(std::max(cur.size(), n));
+        std::copy(u.begin() + from, u.begin() + std::min(from + n, un), cur.begin());
+        cur.resize(normalize_limbs(cur.data(), cur.size()));
+
+        Limbs qc = shift_down(product(cur, x), 2 * n);
+        Limbs qv = product(qc, v);
+        while (compare(qv, cur) > 0) {
+            sub_from(qc, Limbs{1});
+            sub_from(qv, v);
+        }
+        sub_from(cur, qv);
+        while (compare(cur, v) >= 0) {
+            add_to(qc, Limbs{1});
+            sub_from(cur, v);
+        }
+        rem = std::move(cur);
+        for (size_t i = 0; i < qc.size() && from + i < qn; ++i) {
+            q[from + i] = qc[i];
+        }
+    }
+    std::fill(r, r + bn, 0);
+    std::copy(rem.begin(), rem.end(), r);
+    div_limb(r, bn, LimbDivisor(f), r);
+}
+
+}
+
+void divmod_limbs(const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* q, uint32_t* r) {
+    bool newton = std::min(bn, an - bn + 1) >= NEWTON_THRESHOLD;
+    divmod_limbs(newton ? DivAlgorithm::Newton : DivAlgorithm::Long, a, an, b, bn, q, r);
+}
+
+void divmod_limbs(DivAlgorithm algorithm, const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* q, uint32_t* r) {
+    if (algorithm == DivAlgorithm::Newton && bn > 1) {
+        divmod_newton(a, an, b, bn, q, r);
+    } else {
+        divmod_long(a, an, b, bn, q, r);
+    }
+}
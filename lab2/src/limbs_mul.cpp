@@ -0,0 +1,366 @@
+#include "limbs_mul.hpp"
+#include "limbs.hpp"
+
+#include <algorithm>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Limbs = std::vector<uint32_t>;
+
+size_t mul_dispatch(MulAlgorithm algorithm, const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* r);
+
+MulAlgorithm pick_algorithm(size_t an, size_t bn);
+
+// All the helpers below write every one of the an + bn limbs of r
+
+size_t mul_auto(const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* r) {
+    return mul_dispatch(pick_algorithm(an, bn), a, an, b, bn, r);
+}
+
+void mul_schoolbook(const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* r) {
+    std::fill(r, r + an + bn, 0);
+    for (size_t i = 0; i < an; ++i) {
+        uint64_t ai = a[i];
+        uint64_t carry = 0;
+        for (size_t j = 0; j < bn; ++j) {
+            uint64_t cur = r[i + j] + ai * b[j] + carry;
+            carry = cur / LIMB_BASE;
+            r[i + j] = static_cast<uint32_t>(cur % LIMB_BASE);
+        }
+        r[i + bn] = static_cast<uint32_t>(carry);
+    }
+}
+
+// an >= 2 * bn: a is cut into pieces of bn limbs, each one is a balanced product
+void mul_unbalanced(const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* r) {
+    std::fill(r, r + an + bn, 0);
+    Limbs part(2 * bn);
+    for (size_t i = 0; i < an; i += bn) {
+        size_t len = std::min(bn, an - i);
+        size_t pn = mul_auto(a + i, len, b, bn, part.data());
+        add_limbs_inplace(r + i, an + bn - i, part.data(), pn);
+    }
+}
+
+// bn <= an < 2 * bn
+void mul_karatsuba(const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* r) {
+    size_t m = (an + 1) / 2;
+    size_t high = an + bn - 2 * m;
+    // z0 and z2 go straight to their places in r, they do not overlap
+    mul_auto(a, m, b, m, r);
+    mul_auto(a + m, an - m, b + m, bn - m, r + 2 * m);
+
+    Limbs sa(m + 1);
+    Limbs sb(m + 1);
+    size_t san = add_limbs(a, m, a + m, an - m, sa.data());
+    size_t sbn = add_limbs(b, m, b + m, bn - m, sb.data());
+    Limbs z1(san + sbn);
+    size_t z1n = mul_auto(sa.data(), san, sb.data(), sbn, z1.data());
+    z1n = sub_limbs(z1.data(), z1n, r, normalize_limbs(r, 2 * m), z1.data());
+    z1n = sub_limbs(z1.data(), z1n, r + 2 * m, normalize_limbs(r + 2 * m, high), z1.data());
+    add_limbs_inplace(r + m, an + bn - m, z1.data(), z1n);
+}
+
+// Toom-3 evaluates at points that make intermediate values negative
+struct Signed {
+    Limbs limbs;
+    bool negative = false;
+};
+
+Signed piece(const uint32_t* a, size_t an, size_t from, size_t len) {
+    Signed result;
+    if (from < an) {
+        const uint32_t* first = a + from;
+        result.limbs.assign(first, first + normalize_limbs(first, std::min(len, an - from)));
+    }
+    return result;
+}
+
+Signed add(const Signed& x, const Signed& y, bool subtract = false) {
+    bool y_negative = y.negative != subtract;
+    const Limbs& xl = x.limbs;
+    const Limbs& yl = y.limbs;
+    Signed result;
+    if (x.negative == y_negative) {
+        result.limbs.resize(std::max(xl.size(), yl.size()) + 1);
+        result.limbs.resize(add_limbs(xl.data(), xl.size(), yl.data(), yl.size(), result.limbs.data()));
+        result.negative = x.negative;
+    } else if (compare_limbs(xl.data(), xl.size(), yl.data(), yl.size()) >= 0) {
+        result.limbs.resize(xl.size());
+        result.limbs.resize(sub_limbs(xl.data(), xl.size(), yl.data(), yl.size(), result.limbs.data()));
+        result.negative = x.negative;
+    } else {
+        result.limbs.resize(yl.size());
+        result.limbs.resize(sub_limbs(yl.data(), yl.size(), xl.data(), xl.size(), result.limbs.data()));
+        result.negative = y_negative;
+    }
+    result.negative = result.negative && !result.limbs.empty();
+    return result;
+}
+
+Signed sub(const Signed& x, const Signed& y) {
+    return add(x, y, true);
+}
+
+Signed mul(const Signed& x, const Signed& y) {
+    Signed result;
+    result.limbs.resize(x.limbs.size() + y.limbs.size());
+    result.limbs.resize(mul_auto(x.limbs.data(), x.limbs.size(), y.limbs.data(), y.limbs.size(), result.limbs.data()));
+    result.negative = x.negative != y.negative && !result.limbs.empty();
+    return result;
+}
+
+// x /= d, the division must be exact
+Signed div_exact(Signed x, uint32_t d) {
+    uint64_t rem = 0;
+    for (size_t i = x.limbs.size(); i-- > 0;) {
+        uint64_t cur = rem * LIMB_BASE + x.limbs[i];
+        x.limbs[i] = static_cast<uint32_t>(cur / d);
+        rem = cur % d;
+    }
+    x.limbs.resize(normalize_limbs(x.limbs.data(), x.limbs.size()));
+    x.negative = x.negative && !x.limbs.empty();
+    return x;
+}
+
+// bn <= an < 2 * bn; Bodrato's evaluation at 0, 1, -1, -2 and infinity
+void mul_toom3(const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* r) {
+    size_t k = (an + 2) / 3;
+    Signed a0 = piece(a, an, 0, k), a1 = piece(a, an, k, k), a2 = piece(a, an, 2 * k, k);
+    Signed b0 = piece(b, bn, 0, k), b1 = piece(b, bn, k, k), b2 = piece(b, bn, 2 * k, k);
+
+    Signed pa = add(a0, a2);
+    Signed pb = add(b0, b2);
+    Signed a_m1 = sub(pa, a1);
+    Signed b_m1 = sub(pb, b1);
+    Signed a_1 = add(pa, a1);
+    Signed b_1 = add(pb, b1);
+    Signed a_m2 = add(a_m1, a2);
+    a_m2 = sub(add(a_m2, a_m2), a0);
+    Signed b_m2 = add(b_m1, b2);
+    b_m2 = sub(add(b_m2, b_m2), b0);
+
+    Signed r0 = mul(a0, b0);
+    Signed r_1 = mul(a_1, b_1);
+    Signed r_m1 = mul(a_m1, b_m1);
+    Signed r_m2 = mul(a_m2, b_m2);
+    Signed r4 = mul(a2, b2);
+
+    Signed r3 = div_exact(sub(r_m2, r_1), 3);
+    Signed r1 = div_exact(sub(r_1, r_m1), 2);
+    Signed r2 = sub(r_m1, r0);
+    r3 = add(div_exact(sub(r2, r3), 2), add(r4, r4));
+    r2 = sub(add(r2, r1), r4);
+    r1 = sub(r1, r3);
+
+    // the coefficients of the product are non-negative and fit in place
+    size_t rn = an + bn;
+    std::fill(r, r + rn, 0);
+    size_t shift = 0;
+    for (const Signed* coefficient : {&r0, &r1, &r2, &r3, &r4}) {
+        if (!coefficient->limbs.empty()) {
+            add_limbs_inplace(r + shift, rn - shift, coefficient->limbs.data(), coefficient->limbs.size());
+        }
+        shift += k;
+    }
+}
+
+// Limbs go into the transform as they are. A coefficient of the convolution
+// is below min(an, bn) * 10^18, three primes of 30 bits leave room for
+// 7 * 10^7 limbs and it is recovered by CRT.
+constexpr uint32_t NTT_MOD1 = 998'244'353;  // 119 * 2^23 + 1
+constexpr uint32_t NTT_MOD2 = 167'772'161;  // 5 * 2^25 + 1
+constexpr uint32_t NTT_MOD3 = 469'762'049;  // 7 * 2^26 + 1
+constexpr uint32_t NTT_ROOT = 3;            // primitive root of all three
+constexpr size_t NTT_MAX_LENGTH = size_t{1} << 23;
+
+constexpr uint32_t pow_mod(uint64_t base, uint64_t exp, uint32_t mod) {
+    uint64_t result = 1;
+    for (base %= mod; exp > 0; exp >>= 1) {
+        if (exp & 1) {
+            result = result * base % mod;
+        }
+        base = base * base % mod;
+    }
+    return static_cast<uint32_t>(result);
+}
+
+// Montgomery multiplication modulo mod: no division in the butterflies
+template <uint32_t mod>
+struct Montgomery {
+    static constexpr uint32_t inverse() {
+        uint32_t inv = mod;
+        for (int i = 0; i < 4; ++i) {
+            inv *= 2 - mod * inv;
+        }
+        return inv;
+    }
+
+    static constexpr uint32_t NEG_INV = 0 - inverse();
+    static constexpr uint32_t R = (uint64_t{1} << 32) % mod;
+    static constexpr uint32_t R2 = uint64_t{R} * R % mod;
+
+    // x * y / 2^32 modulo mod
+    static uint32_t mul(uint32_t x, uint32_t y) {
+        uint64_t t = uint64_t{x} * y;
+        uint32_t m = static_cast<uint32_t>(t) * NEG_INV;
+        uint32_t u = static_cast<uint32_t>((t + uint64_t{m} * mod) >> 32);
+        return u >= mod ? u - mod : u;
+    }
+};
+
+// Values stay in the normal form, only the roots are kept multiplied by 2^32,
+// so mul(value, root) is the plain product
+template <uint32_t mod>
+void ntt(Limbs& a, bool invert) {
+    using M = Montgomery<mod>;
+    size_t n = a.size();
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(a[i], a[j]);
+        }
+    }
+    Limbs roots;
+    for (size_t len = 2; len <= n; len <<= 1) {
+        // w^-1 is w^(mod - 1 - (mod - 1) / len)
+        uint64_t step = (mod - 1) / len;
+        uint32_t w = pow_mod(NTT_ROOT, invert ? mod - 1 - step : step, mod);
+        uint32_t w_mont = M::mul(w, M::R2);
+        size_t half = len / 2;
+        roots.resize(half);
+        roots[0] = M::R;
+        for (size_t j = 1; j < half; ++j) {
+            roots[j] = M::mul(roots[j - 1], w_mont);
+        }
+        for (size_t i = 0; i < n; i += len) {
+            uint32_t* lo = a.data() + i;
+            uint32_t* hi = lo + half;
+            for (size_t j = 0; j < half; ++j) {
+                uint32_t u = lo[j];
+                uint32_t v = M::mul(hi[j], roots[j]);
+                lo[j] = u + v < mod ? u + v : u + v - mod;
+                hi[j] = u >= v ? u - v : u + mod - v;
+            }
+        }
+    }
+}
+
+// Cyclic convolution of a and b modulo mod, length is a power of two
+template <uint32_t mod>
+Limbs convolve(const uint32_t* a, size_t an, const uint32_t* b, size_t bn, size_t length) {
+    using M = Montgomery<mod>;
+    Limbs fa(length, 0);
+    Limbs fb(length, 0);
+    // limbs are below 10^9 but not always below mod
+    for (size_t i = 0; i < an; ++i) {
+        fa[i] = a[i] % mod;
+    }
+    for (size_t i = 0; i < bn; ++i) {
+        fb[i] = b[i] % mod;
+    }
+    ntt<mod>(fa, false);
+    ntt<mod>(fb, false);
+    // the product loses a factor 2^32 and the inverse transform gains length;
+    // scale brings both back
+    uint32_t scale = M::mul(M::mul(pow_mod(length, mod - 2, mod), M::R2), M::R2);
+    for (size_t i = 0; i < length; ++i) {
+        fa[i] = M::mul(M::mul(fa[i], fb[i]), scale);
+    }
+    ntt<mod>(fa, true);
+    return fa;
+}
+
+bool ntt_fits(size_t an, size_t bn) {
+    return an + bn <= NTT_MAX_LENGTH;
+}
+
+void mul_ntt(const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* r) {
+    size_t rn = an + bn;
+    size_t length = 1;
+    while (length < rn) {
+        length <<= 1;
+    }
+    Limbs c1 = convolve<NTT_MOD1>(a, an, b, bn, length);
+    Limbs c2 = convolve<NTT_MOD2>(a, an, b, bn, length);
+    Limbs c3 = convolve<NTT_MOD3>(a, an, b, bn, length);
+
+    // Garner: x = r1 + t2 * m1 + t3 * m1 * m2
+    constexpr uint64_t INV_M1_M2 = pow_mod(NTT_MOD1, NTT_MOD2 - 2, NTT_MOD2);
+    constexpr uint64_t INV_M1M2_M3 = pow_mod(uint64_t{NTT_MOD1} * NTT_MOD2 % NTT_MOD3, NTT_MOD3 - 2, NTT_MOD3);
+    constexpr uint64_t M1M2 = uint64_t{NTT_MOD1} * NTT_MOD2;
+    unsigned __int128 carry = 0;
+    for (size_t i = 0; i < rn; ++i) {
+        uint64_t r1 = c1[i];
+        uint64_t t2 = (c2[i] + NTT_MOD2 - r1 % NTT_MOD2) * INV_M1_M2 % NTT_MOD2;
+        uint64_t x12 = r1 + t2 * NTT_MOD1;
+        uint64_t t3 = (c3[i] + NTT_MOD3 - x12 % NTT_MOD3) * INV_M1M2_M3 % NTT_MOD3;
+        carry += x12 + static_cast<unsigned __int128>(t3) * M1M2;
+        r[i] = static_cast<uint32_t>(carry % LIMB_BASE);
+        carry /= LIMB_BASE;
+    }
+}
+
+MulAlgorithm pick_algorithm(size_t an, size_t bn) {
+    size_t shorter = std::min(an, bn);
+    if (shorter < KARATSUBA_THRESHOLD) {
+        return MulAlgorithm::Schoolbook;
+    }
+    if (shorter < TOOM3_THRESHOLD) {
+        return MulAlgorithm::Karatsuba;
+    }
+    if (shorter < NTT_THRESHOLD || !ntt_fits(an, bn)) {
+        return MulAlgorithm::Toom3;
+    }
+    return MulAlgorithm::Ntt;
+}
+
+size_t mul_dispatch(MulAlgorithm algorithm, const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* r) {
+    if (an < bn) {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+    if (bn == 0) {
+        std::fill(r, r + an, 0);
+        return 0;
+    }
+    if (algorithm == MulAlgorithm::Schoolbook) {
+        mul_schoolbook(a, an, b, bn, r);
+    } else if (algorithm == MulAlgorithm::Ntt && ntt_fits(an, bn)) {
+        mul_ntt(a, an, b, bn, r);
+    } else if (an >= 2 * bn) {
+        mul_unbalanced(a, an, b, bn, r);
+    } else if (algorithm == MulAlgorithm::Karatsuba) {
+        mul_karatsuba(a, an, b, bn, r);
+    } else {
+        mul_toom3(a, an, b, bn, r);
+    }
+    return normalize_limbs(r, an + bn);
+}
+
+}
+
+size_t mul_limbs(const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* r) {
+    return mul_auto(a, an, b, bn, r);
+}
+
+size_t mul_limbs(MulAlgorithm algorithm, const uint32_t* a, size_t an, const uint32_t* b, size_t bn, uint32_t* r) {
+    return mul_dispatch(algorithm, a, an, b, bn, r);
+}
+
+uint32_t mul_limb_inplace(uint32_t* a, size_t an, uint32_t m) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < an; ++i) {
+        uint64_t cur = uint64_t{a[i]} * m + carry;
+        a[i] = static_cast<uint32_t>(cur % LIMB_BASE);
+        carry = cur / LIMB_BASE;
+    }
+    return static_cast<uint32_t>(carry);
+}
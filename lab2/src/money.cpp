@@ -1,195 +1,513 @@
 #include "money.hpp"
+#include "limbs.hpp"
+#include "limbs_div.hpp"
+#include "limbs_mul.hpp"
 
 #include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <memory>
 #include <stdexcept>
 #include <sstream>
 
-Money::Money(): data(nullptr), size(0) {}
+Money::Money(): Money(std::pmr::get_default_resource()) {}
 
-Money::Money(size_t n, unsigned char t) {
+Money::Money(std::pmr::memory_resource* resource): data(local), size(0), capacity(INLINE_LIMBS), digits(0), negative(false), resource(resource), local{} {}
+
+Money::Money(size_t n, unsigned char t): Money() {
     if (!isdigit(t)) {
         throw std::invalid_argument("Money::Money(): t must be an integer");
     }
-    size = n;
-    data = new unsigned char[size];
-
-    for (size_t i = 0; i < size; i++) {
-        data[i] = t;
+    // every limb is t repeated, only the top one may be shorter
+    reserve((n + LIMB_DIGITS - 1) / LIMB_DIGITS);
+    uint32_t digit = t - '0';
+    for (size_t left = n; left > 0; left -= std::min(left, LIMB_DIGITS)) {
+        uint32_t limb = 0;
+        for (size_t i = 0; i < std::min(left, LIMB_DIGITS); ++i) {
+            limb = limb * 10 + digit;
+        }
+        data[size++] = limb;
     }
+    size = normalize_limbs(data, size);
+    digits = n;
 }
 
-Money::Money(const Money& other) {
+Money::Money(const Money& other): Money(other, std::pmr::get_default_resource()) {}
+
+Money::Money(const Money& other, std::pmr::memory_resource* resource): Money(resource) {
+    reserve(other.size);
+    std::copy(other.data, other.data + other.size, data);
     size = other.size;
-    data = new unsigned char[size];
-    for (size_t i = 0; i < size; i++) {
-        data[i] = other.data[i];
+    digits = other.digits;
+    negative = other.negative;
+}
+
+bool Money::is_inline() const {
+    return data == local;
+}
+
+void Money::reserve(size_t limbs) {
+    if (limbs <= capacity) {
+        return;
     }
+    auto* block = static_cast<uint32_t*>(resource->allocate(limbs * sizeof(uint32_t), alignof(uint32_t)));
+    std::copy(data, data + size, block);
+    if (!is_inline()) {
+        resource->deallocate(data, capacity * sizeof(uint32_t), alignof(uint32_t));
+    }
+    data = block;
+    capacity = limbs;
 }
 
 void Money::swap(Money& other) noexcept {
+    if (!is_inline() && !other.is_inline()) {
+        std::swap(data, other.data);
+    } else if (is_inline() && other.is_inline()) {
+        std::swap(local, other.local);
+    } else {
+        // the inline value moves into the other object, the heap block the other way
+        Money& small = is_inline() ? *this : other;
+        Money& large = is_inline() ? other : *this;
+        uint32_t* block = large.data;
+        std::copy(small.local, small.local + INLINE_LIMBS, large.local);
+        large.data = large.local;
+        small.data = block;
+    }
     std::swap(size, other.size);
-    std::swap(data, other.data);
+    std::swap(capacity, other.capacity);
+    std::swap(digits, other.digits);
+    std::swap(negative, other.negative);
+    std::swap(resource, other.resource);
+}
+
+void Money::take(Money& other) {
+    if (resource == other.resource) {
+        swap(other);
+    } else {
+        *this = other;
+    }
 }
 
 Money& Money::operator=(const Money& other) {
     if (this == &other) {
         return *this;
     }
-    // idiom copy and swap
-    Money tmp = other;
-    swap(tmp);
+    // the buffer is reused when it is large enough; otherwise the copy is
+    // built aside, so *this is untouched if allocating throws
+    if (other.size > capacity) {
+        Money copy(other, resource);
+        take(copy);
+        return *this;
+    }
+    std::copy(other.data, other.data + other.size, data);
+    size = other.size;
+    digits = other.digits;
+    negative = other.negative;
     return *this;
 }
 
-Money& Money::operator=(Money&& other) noexcept {
-    size = other.size;
-    data = other.data;
-    other.size = 0;
-    other.data = nullptr;
+Money& Money::operator=(Money&& other) {
+    if (this != &other) {
+        take(other);
+    }
     return *this;
 }
 
-Money::Money(const std::initializer_list<unsigned char>& other) {
-    size_t i = 0;
-    size = other.size();
-    data = new unsigned char[size];
+Money::Money(const std::initializer_list<unsigned char>& other): Money() {
     for (unsigned char ch : other) {
         if (!isdigit(ch)) {
-            delete[] data;
             throw std::invalid_argument("Money::Money(): std::initializer_list must be a number");
         }
-        data[i++] = ch;
     }
+    const char* first = reinterpret_cast<const char*>(other.begin());
+    assign_digits(first, first + other.size());
 }
 
 
-Money::Money(const std::string& other) {
-    if (other.empty()) throw std::invalid_argument("Empty string");
+Money::Money(const std::string& other): Money(other, std::pmr::get_default_resource()) {}
 
-    size = other.size();
-    data = new unsigned char[size];
-    for (size_t i = 0; i < size; i++) {
-        if (!isdigit(other[i]) && i != 0 && other[i] != '-') {
-            delete[] data;
-            throw std::invalid_argument("Money::Money(): std::string must be a number");
-        }
-        data[i] = static_cast<unsigned char>(other[i]);
+Money::Money(const std::string& other, std::pmr::memory_resource* resource): Money(resource) {
+    const char* last = other.data() + other.size();
+    // '+' is for from_chars only; the constructor keeps taking just '-'
+    if (!other.empty() && other[0] == '+') {
+        throw std::invalid_argument("Money::Money(): std::string must be a number");
+    }
+    auto [end, ec] = from_chars(other.data(), last, *this);
+    if (ec != std::errc() || end != last) {
+        throw std::invalid_argument("Money::Money(): std::string must be a number");
     }
 }
 
-Money::Money(Money&& other) noexcept {
-    data = other.data;
-    size = other.size;
-    other.data = nullptr;
-    other.size = 0;
+Money::Money(Money&& other) noexcept: Money() {
+    swap(other);
 }
 
-bool Money::operator==(const Money& other) const {
-    return stoi(data, size) == stoi(other.data, other.size);
-}
-
-bool Money::operator!=(const Money& other) const {
-    return !(*this == other);
+void Money::assign_digits(const char* first, const char* last) {
+    size = 0;
+    reserve((last - first + LIMB_DIGITS - 1) / LIMB_DIGITS);
+    size = parse_limbs(first, last, data);
+    digits = last - first;
 }
 
-
-bool Money::operator>(const Money& other) const {
-    return stoi(data, size) > stoi(other.data, other.size);
+void Money::normalize() {
+    size = normalize_limbs(data, size);
+    digits = std::max<size_t>(count_digits(data, size), 1);
+    if (size == 0) {
+        negative = false;
+    }
 }
 
-bool Money::operator>=(const Money& other) const {
-    return stoi(data, size) >= stoi(other.data, other.size);
+int Money::compare(const Money& other) const {
+    // "-0" from the string constructor keeps its sign for printing only
+    bool lhs_negative = negative && size > 0;
+    bool rhs_negative = other.negative && other.size > 0;
+    if (lhs_negative != rhs_negative) {
+        return lhs_negative ? -1 : 1;
+    }
+    int result = compare_limbs(data, size, other.data, other.size);
+    return lhs_negative ? -result : result;
 }
 
-bool Money::operator<(const Money& other) const {
-    return !(*this >= other);
+std::weak_ordering Money::operator<=>(const Money& other) const {
+    return compare(other) <=> 0;
 }
 
-bool Money::operator<=(const Money& other) const {
-    return !(*this > other);
+bool Money::operator==(const Money& other) const {
+    return compare(other) == 0;
 }
 
 
 size_t Money::GetLength() const {
-    return size;
+    return digits + (negative ? 1 : 0);
+}
+
+std::pmr::memory_resource* Money::get_resource() const {
+    return resource;
 }
 
 
 Money::~Money() noexcept {
-    if (data != nullptr) {
-        delete[] data;
-        data = nullptr;
+    if (!is_inline()) {
+        resource->deallocate(data, capacity * sizeof(uint32_t), alignof(uint32_t));
     }
+    data = nullptr;
     size = 0;
 }
 
-Money operator+(const Money& lhs, const Money& rhs) {
-    std::string result;
+void Money::add(const Money& other, bool subtract) {
+    bool other_negative = other.negative != subtract;
+    // a sum keeps the width of the wider operand, as "007" + "1" prints "008";
+    // a difference drops its leading zeros
+    bool same_sign = negative == other_negative;
+    size_t width = same_sign ? std::max(digits, other.digits) : 0;
+    // other may be *this, so its data is read only after reserve()
+    if (same_sign) {
+        if (size < other.size) {
+            reserve(other.size);
+            std::fill(data + size, data + other.size, 0);
+            size = other.size;
+        }
+        if (add_limbs_inplace(data, size, other.data, other.size)) {
+            reserve(size + 1);
+            data[size++] = 1;
+        }
+    } else if (compare_limbs(data, size, other.data, other.size) >= 0) {
+        size = sub_limbs(data, size, other.data, other.size, data);
+    } else {
+        reserve(other.size);
+        size = sub_limbs(other.data, other.size, data, size, data);
+        negative = other_negative;
+    }
+    normalize();
+    digits = std::max(digits, width);
+}
 
-    const unsigned char* lhs_data = lhs.data;
-    const unsigned char* rhs_data = rhs.data;
+Money& Money::operator+=(const Money& other) {
+    add(other, false);
+    return *this;
+}
 
-    int32_t i = lhs.size - 1;
-    int32_t j = rhs.size - 1;
+Money& Money::operator-=(const Money& other) {
+    add(other, true);
+    return *this;
+}
 
-    int32_t rem = 0;
-    while (i >= 0 || j >= 0 || rem) {
-        int32_t sum = rem;
-        if (i >= 0) sum += lhs_data[i--] - '0';
-        if (j >= 0) sum += rhs_data[j--] - '0';
+Money operator+(const Money& lhs, const Money& rhs) {
+    Money result = lhs;
+    result += rhs;
+    return result;
+}
 
-        result.push_back(sum % 10 + '0');
-        rem = sum / 10;
-    }
-    reverse(result.begin(), result.end());
-    return {result};
+Money operator+(Money&& lhs, const Money& rhs) {
+    lhs += rhs;
+    return std::move(lhs);
 }
 
 Money operator-(const Money& lhs, const Money& rhs) {
-    std::string result;
+    Money result = lhs;
+    result -= rhs;
+    return result;
+}
+
+Money operator-(Money&& lhs, const Money& rhs) {
+    lhs -= rhs;
+    return std::move(lhs);
+}
 
-    const unsigned char* lhs_data = lhs.data;
-    const unsigned char* rhs_data = rhs.data;
+Money operator*(const Money& lhs, const Money& rhs) {
+    Money result;
+    result.reserve(lhs.size + rhs.size);
+    result.size = mul_limbs(lhs.data, lhs.size, rhs.data, rhs.size, result.data);
+    result.negative = lhs.negative != rhs.negative;
+    result.normalize();
+    return result;
+}
+
+Money operator*(const Money& lhs, int64_t rhs) {
+    Money result = lhs;
+    result *= rhs;
+    return result;
+}
 
-    int32_t i = lhs.size - 1;
-    int32_t j = rhs.size - 1;
+Money operator*(int64_t lhs, const Money& rhs) {
+    return rhs * lhs;
+}
 
-    int32_t rem = 0;
-    while (i >= 0 || j >= 0) {
-        int32_t sum = rem;
-        rem = 0;
-        if (i >= 0)
-            sum += lhs_data[i--] - '0';
-        if (j >= 0)
-            sum -= rhs_data[j--] - '0';
+Money& Money::operator*=(const Money& other) {
+    Money result = *this * other;
+    take(result);
+    return *this;
+}
 
-        if (sum < 0)
-            rem = -1;
-        result.push_back((sum + 10) % 10 + '0');
+Money& Money::operator*=(int64_t factor) {
+    uint64_t magnitude = factor < 0 ? 0 - static_cast<uint64_t>(factor) : static_cast<uint64_t>(factor);
+    if (magnitude < LIMB_BASE) {
+        if (uint32_t carry = mul_limb_inplace(data, size, static_cast<uint32_t>(magnitude))) {
+            reserve(size + 1);
+            data[size++] = carry;
+        }
+        negative = negative != (factor < 0);
+        normalize();
+        return *this;
     }
-    while (result.size() - 1 && result.back() == '0') {
-        result.pop_back();
+    return *this *= of(factor);
+}
+
+Money Money::of(int64_t value) {
+    uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    // 2^63 takes three limbs
+    Money result;
+    for (; magnitude > 0; magnitude /= LIMB_BASE) {
+        result.local[result.size++] = static_cast<uint32_t>(magnitude % LIMB_BASE);
+    }
+    result.negative = value < 0;
+    result.normalize();
+    return result;
+}
+
+void Money::divide(const Money& lhs, const Money& rhs, Money* quotient, Money* remainder) {
+    if (rhs.size == 0) {
+        throw std::invalid_argument("Money: division by zero");
+    }
+    Money q;
+    Money r;
+    if (compare_limbs(lhs.data, lhs.size, rhs.data, rhs.size) < 0) {
+        r = lhs;
+    } else {
+        q.reserve(lhs.size - rhs.size + 1);
+        r.reserve(rhs.size);
+        divmod_limbs(lhs.data, lhs.size, rhs.data, rhs.size, q.data, r.data);
+        q.size = lhs.size - rhs.size + 1;
+        r.size = rhs.size;
+        q.negative = lhs.negative != rhs.negative;
+        r.negative = lhs.negative;
     }
-    if (rem < 0) {
-        result.push_back('-');
+    q.normalize();
+    r.normalize();
+    if (quotient) {
+        quotient->take(q);
+    }
+    if (remainder) {
+        remainder->take(r);
     }
-    reverse(result.begin(), result.end());
-    return {result};
 }
 
+Money operator/(const Money& lhs, const Money& rhs) {
+    Money result;
+    Money::divide(lhs, rhs, &result, nullptr);
+    return result;
+}
 
-std::ostream& operator<<(std::ostream& os, const Money& m) {
-    const unsigned char* data = m.data;
-    for (size_t i = 0; i < m.size; ++i) {
-        os << data[i];
+Money operator/(const Money& lhs, int64_t rhs) {
+    Money result = lhs;
+    result /= rhs;
+    return result;
+}
+
+Money operator%(const Money& lhs, const Money& rhs) {
+    Money result;
+    Money::divide(lhs, rhs, nullptr, &result);
+    return result;
+}
+
+Money operator%(const Money& lhs, int64_t rhs) {
+    Money result = lhs;
+    result %= rhs;
+    return result;
+}
+
+Money& Money::operator/=(const Money& other) {
+    divide(*this, other, this, nullptr);
+    return *this;
+}
+
+Money& Money::operator/=(int64_t divisor) {
+    uint64_t magnitude = divisor < 0 ? 0 - static_cast<uint64_t>(divisor) : static_cast<uint64_t>(divisor);
+    if (magnitude == 0 || magnitude > UINT32_MAX) {
+        return *this /= of(divisor);
     }
-    return os;
+    div_limb(data, size, LimbDivisor(static_cast<uint32_t>(magnitude)), data);
+    negative = negative != (divisor < 0);
+    normalize();
+    return *this;
+}
+
+Money& Money::operator%=(const Money& other) {
+    divide(*this, other, nullptr, this);
+    return *this;
+}
+
+Money& Money::operator%=(int64_t divisor) {
+    uint64_t magnitude = divisor < 0 ? 0 - static_cast<uint64_t>(divisor) : static_cast<uint64_t>(divisor);
+    if (magnitude == 0 || magnitude > UINT32_MAX) {
+        return *this %= of(divisor);
+    }
+    uint32_t rem = div_limb(data, size, LimbDivisor(static_cast<uint32_t>(magnitude)), data);
+    reserve(2);
+    size = 0;
+    if (rem >= LIMB_BASE) {
+        data[size++] = rem % LIMB_BASE;
+        data[size++] = rem / LIMB_BASE;
+    } else {
+        data[size++] = rem;
+    }
+    normalize();
+    return *this;
 }
 
-int32_t stoi(const unsigned char* data, size_t size) {
-    int32_t result = 0;
-    for (size_t i = 0; i < size; ++i) {
-        result = result * 10 + data[i] - '0';
+std::vector<Money> Money::allocate(size_t parts) const {
+    if (parts == 0 || parts > INT64_MAX) {
+        throw std::invalid_argument("Money::allocate(): parts must be positive");
+    }
+    Money share;
+    Money rest;
+    divide(*this, of(static_cast<int64_t>(parts)), &share, &rest);
+    // |rest| < parts, so it fits 64 bits
+    uint64_t extra = 0;
+    for (size_t i = rest.size; i-- > 0;) {
+        extra = extra * LIMB_BASE + rest.data[i];
+    }
+    Money bigger = share + of(negative ? -1 : 1);
+    std::vector<Money> result;
+    result.reserve(parts);
+    for (size_t i = 0; i < parts; ++i) {
+        result.push_back(i < extra ? bigger : share);
     }
     return result;
 }
+
+
+std::from_chars_result from_chars(const char* first, const char* last, Money& value) {
+    bool negative = first != last && *first == '-';
+    const char* begin = first != last && (*first == '-' || *first == '+') ? first + 1 : first;
+    const char* end = find_non_digit(begin, last);
+    if (end == begin) {
+        return {first, std::errc::invalid_argument};
+    }
+    value.assign_digits(begin, end);
+    value.negative = negative;
+    return {end, std::errc()};
+}
+
+std::from_chars_result from_chars(std::string_view text, Money& value) {
+    return from_chars(text.data(), text.data() + text.size(), value);
+}
+
+std::to_chars_result to_chars(char* first, char* last, const Money& value) {
+    if (last - first < static_cast<ptrdiff_t>(value.GetLength())) {
+        return {last, std::errc::value_too_large};
+    }
+    if (value.negative) {
+        *first++ = '-';
+    }
+    // leading zeros the amount was created with
+    size_t zeros = value.digits - std::min(value.digits, count_digits(value.data, value.size));
+    first = std::fill_n(first, zeros, '0');
+    return {format_limbs(value.data, value.size, first), std::errc()};
+}
+
+std::to_chars_result to_chars(char* first, char* last, const Money& value, char separator) {
+    size_t separators = value.digits > 0 ? (value.digits - 1) / 3 : 0;
+    if (last - first < static_cast<ptrdiff_t>(value.GetLength() + separators)) {
+        return {last, std::errc::value_too_large};
+    }
+    char* digits = to_chars(first, last, value).ptr - value.digits;
+    // spreads the groups from the back, every one moves right by the
+    // separators still in front of it
+    char* end = digits + value.digits + separators;
+    char* from = digits + value.digits;
+    for (char* to = end; separators > 0; --separators) {
+        to -= 3;
+        from -= 3;
+        std::memmove(to, from, 3);
+        *--to = separator;
+    }
+    return {end, std::errc()};
+}
+
+std::ostream& operator<<(std::ostream& os, const Money& m) {
+    // a formatted output: nothing is written to a failed stream, tie() is
+    // flushed, and a short write sets badbit
+    std::ostream::sentry ok(os);
+    if (!ok) {
+        return os;
+    }
+    char local[128];
+    std::unique_ptr<char[]> heap;
+    char* text = local;
+    if (m.GetLength() > sizeof(local)) {
+        heap = std::make_unique_for_overwrite<char[]>(m.GetLength());
+        text = heap.get();
+    }
+    auto [end, ec] = to_chars(text, text + m.GetLength(), m);
+
+    // setw() pads the whole amount, as for a built-in number, and is reset
+    std::streamsize length = end - text;
+    std::streamsize pad = std::max<std::streamsize>(os.width() - length, 0);
+    os.width(0);
+    std::ios_base::fmtflags adjust = os.flags() & std::ios_base::adjustfield;
+    std::streamsize before = adjust == std::ios_base::left ? 0 : pad;
+    std::streambuf* buffer = os.rdbuf();
+    char fill = os.fill();
+    auto put_fill = [&](std::streamsize count) {
+        for (; count > 0; --count) {
+            if (buffer->sputc(fill) == std::char_traits<char>::eof()) {
+                return false;
+            }
+        }
+        return true;
+    };
+    bool written = true;
+    if (adjust == std::ios_base::internal && m.negative) {
+        written = buffer->sputc('-') != std::char_traits<char>::eof();
+        ++text;
+        --length;
+    }
+    written = written && put_fill(before);
+    written = written && buffer->sputn(text, length) == length;
+    written = written && put_fill(pad - before);
+    if (!written) {
+        os.setstate(std::ios_base::badbit);
+    }
+    return os;
+}
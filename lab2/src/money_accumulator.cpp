@@ -0,0 +1,91 @@
+#include "money_accumulator.hpp"
+#include "limbs.hpp"
+
+#include <algorithm>
+#include <utility>
+
+MoneyAccumulator::MoneyAccumulator(uint64_t max_pending): max_pending(std::clamp<uint64_t>(max_pending, 1, MAX_PENDING)) {}
+
+MoneyAccumulator& MoneyAccumulator::add(const Money& value) {
+    settle_if_full(1);
+    std::vector<uint64_t>& lanes = value.negative ? negative : positive;
+    if (lanes.size() < value.size) {
+        lanes.resize(value.size, 0);
+    }
+    for (size_t i = 0; i < value.size; ++i) {
+        lanes[i] += value.data[i];
+    }
+    ++pending;
+    return *this;
+}
+
+MoneyAccumulator& MoneyAccumulator::add(std::span<const Money> values) {
+    for (const Money& value : values) {
+        add(value);
+    }
+    return *this;
+}
+
+MoneyAccumulator& MoneyAccumulator::merge(const MoneyAccumulator& other) {
+    // every lane of other counts as pending additions of its own, plus one
+    // for what it has already settled below LIMB_BASE
+    settle_if_full(other.pending + 1);
+    for (auto [lanes, from] : {std::pair{&positive, &other.positive}, std::pair{&negative, &other.negative}}) {
+        if (lanes->size() < from->size()) {
+            lanes->resize(from->size(), 0);
+        }
+        for (size_t i = 0; i < from->size(); ++i) {
+            (*lanes)[i] += (*from)[i];
+        }
+    }
+    pending += other.pending + 1;
+    return *this;
+}
+
+Money MoneyAccumulator::total() const {
+    std::vector<uint64_t> pos = positive;
+    std::vector<uint64_t> neg = negative;
+    settle(pos);
+    settle(neg);
+    Money result;
+    result.reserve(pos.size());
+    std::copy(pos.begin(), pos.end(), result.data);
+    result.size = pos.size();
+    result.normalize();
+    Money minus;
+    minus.reserve(neg.size());
+    std::copy(neg.begin(), neg.end(), minus.data);
+    minus.size = neg.size();
+    minus.normalize();
+    result -= minus;
+    return result;
+}
+
+void MoneyAccumulator::reset() {
+    positive.clear();
+    negative.clear();
+    pending = 0;
+}
+
+void MoneyAccumulator::settle(std::vector<uint64_t>& lanes) {
+    uint64_t carry = 0;
+    for (uint64_t& lane : lanes) {
+        lane += carry;
+        carry = lane / LIMB_BASE;
+        lane %= LIMB_BASE;
+    }
+    for (; carry > 0; carry /= LIMB_BASE) {
+        lanes.push_back(carry % LIMB_BASE);
+    }
+    while (!lanes.empty() && lanes.back() == 0) {
+        lanes.pop_back();
+    }
+}
+
+void MoneyAccumulator::settle_if_full(uint64_t incoming) {
+    if (pending + incoming > max_pending) {
+        settle(positive);
+        settle(negative);
+        pending = 0;
+    }
+}
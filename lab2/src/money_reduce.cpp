@@ -0,0 +1,106 @@
+#include "money_reduce.hpp"
+
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <exception>
+#include <latch>
+#include <thread>
+
+namespace {
+
+// Smaller chunks are not worth a thread
+constexpr size_t MIN_CHUNK = 1 << 14;
+
+}
+
+double ReduceThreadStats::items_per_second() const {
+    return seconds > 0 ? static_cast<double>(items) / seconds : 0;
+}
+
+Money reduce_chunks(size_t count, unsigned threads,
+                    const std::function<void(size_t, size_t, MoneyAccumulator&)>& work,
+                    std::vector<ReduceThreadStats>* stats) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t chunks = std::max<size_t>(1, std::min<size_t>(threads, count / MIN_CHUNK));
+    size_t chunk_size = (count + chunks - 1) / chunks;
+    std::vector<MoneyAccumulator> accumulators(chunks);
+    std::vector<ReduceThreadStats> local(chunks);
+    // an exception stays with its worker until every thread has joined
+    std::vector<std::exception_ptr> errors(chunks);
+    std::barrier merged(static_cast<std::ptrdiff_t>(chunks));
+
+    auto run = [&](size_t id) {
+        size_t first = std::min(count, id * chunk_size);
+        size_t last = std::min(count, first + chunk_size);
+        auto start = std::chrono::steady_clock::now();
+        try {
+            work(first, last, accumulators[id]);
+        } catch (...) {
+            errors[id] = std::current_exception();
+        }
+        local[id].items = last - first;
+        local[id].seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // tree: on every level the left one of each pair takes the right one.
+        // A failed worker still arrives on every level, or the others would
+        // wait for it forever.
+        for (size_t step = 1; step < chunks; step *= 2) {
+            merged.arrive_and_wait();
+            if (id % (2 * step) == 0 && id + step < chunks && !errors[id]) {
+                try {
+                    accumulators[id].merge(accumulators[id + step]);
+                } catch (...) {
+                    errors[id] = std::current_exception();
+                }
+            }
+        }
+    };
+
+    {
+        // Workers reach the barrier only once all of them exist: if starting
+        // one throws, the ones already running leave without arriving
+        std::latch started(1);
+        bool failed = false;
+        auto worker = [&](size_t id) {
+            started.wait();
+            if (!failed) {
+                run(id);
+            }
+        };
+
+        std::vector<std::jthread> workers;
+        workers.reserve(chunks - 1);
+        try {
+            for (size_t id = 1; id < chunks; ++id) {
+                workers.emplace_back(worker, id);
+            }
+        } catch (...) {
+            failed = true;
+            started.count_down();
+            throw;
+        }
+        started.count_down();
+        run(0);
+    }
+    for (const std::exception_ptr& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    if (stats) {
+        *stats = std::move(local);
+    }
+    return accumulators[0].total();
+}
+
+Money parallel_sum(std::span<const Money> values, unsigned threads, std::vector<ReduceThreadStats>* stats) {
+    return reduce_chunks(
+        values.size(), threads,
+        [values](size_t first, size_t last, MoneyAccumulator& accumulator) {
+            accumulator.add(values.subspan(first, last - first));
+        },
+        stats);
+}
@@ -1,8 +1,20 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <iomanip>
+#include <memory_resource>
+#include <random>
 #include <sstream>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
+#include "limbs.hpp"
+#include "limbs_div.hpp"
+#include "limbs_mul.hpp"
 #include "money.hpp"
+#include "money_accumulator.hpp"
+#include "money_reduce.hpp"
 
 class MoneyTest : public ::testing::Test {
 protected:
@@ -194,3 +206,663 @@ TEST_F(MoneyTest, TestArithmeticProperties) {
     ASSERT_EQ(money1 - money1, Money("0"));
     ASSERT_EQ(money4 - money4, Money("0"));
 }
+
+TEST_F(MoneyTest, TestLimbBoundaries) {
+    // перенос через границу limb'а (9 цифр)
+    ASSERT_EQ(Money("999999999999999999") + Money("1"), Money("1000000000000000000"));
+    ASSERT_EQ(Money("1000000000000000000") - Money("1"), Money("999999999999999999"));
+    ASSERT_EQ(Money("1000000000") - Money("999999999"), Money("1"));
+
+    // сравнение больше int32_t
+    ASSERT_GT(Money("12345678901234567890"), Money("12345678901234567889"));
+    ASSERT_LT(Money("99999999999"), Money("100000000000"));
+
+    std::stringstream ss;
+    ss << Money("1000000000000000000") + Money("23");
+    ASSERT_EQ(ss.str(), "1000000000000000023");
+}
+
+TEST_F(MoneyTest, TestSignedArithmetic) {
+    std::stringstream ss;
+    ss << money1 - money2;
+    ASSERT_EQ(ss.str(), "-12");
+
+    ASSERT_EQ(Money("-5") + Money("3"), Money("-2"));
+    ASSERT_EQ(Money("-5") + Money("-3"), Money("-8"));
+    ASSERT_EQ(Money("-5") - Money("-7"), Money("2"));
+    ASSERT_EQ(Money("-0"), Money("0"));
+    ASSERT_LT(Money("-10"), Money("-9"));
+}
+
+TEST_F(MoneyTest, TestLeadingZerosKept) {
+    std::stringstream ss;
+    ss << Money("007");
+    ASSERT_EQ(ss.str(), "007");
+    ASSERT_EQ(Money("007").GetLength(), 3);
+    ASSERT_EQ(Money("007"), Money("7"));
+
+    ss.str("");
+    ss << Money(3, '0');
+    ASSERT_EQ(ss.str(), "000");
+
+    ss.str("");
+    ss << Money();
+    ASSERT_EQ(ss.str(), "");
+    ASSERT_EQ(Money("-42").GetLength(), 3);
+
+    // сумма сохраняет ширину более длинного слагаемого, разность - нет
+    ss.str("");
+    ss << Money("007") + Money("1");
+    ASSERT_EQ(ss.str(), "008");
+    Money sum("1");
+    sum += Money("0099");
+    ss.str("");
+    ss << sum;
+    ASSERT_EQ(ss.str(), "0100");
+    ss.str("");
+    ss << Money("009") + Money("1");
+    ASSERT_EQ(ss.str(), "010");
+    ss.str("");
+    ss << Money("999") + Money("1");
+    ASSERT_EQ(ss.str(), "1000");
+    ss.str("");
+    ss << Money("010") - Money("3");
+    ASSERT_EQ(ss.str(), "7");
+}
+
+TEST_F(MoneyTest, TestInvalidSign) {
+    ASSERT_THROW(Money("-"), std::invalid_argument);
+    ASSERT_THROW(Money("1-2"), std::invalid_argument);
+    ASSERT_THROW(Money("a12"), std::invalid_argument);
+    ASSERT_THROW(Money("12-"), std::invalid_argument);
+    ASSERT_THROW(Money(""), std::invalid_argument);
+    ASSERT_THROW(Money("+12"), std::invalid_argument);
+}
+
+TEST_F(MoneyTest, TestFromChars) {
+    Money value("5");
+    std::string_view text = "-0012345678901234567890;rest";
+    auto [end, ec] = from_chars(text, value);
+    ASSERT_EQ(ec, std::errc());
+    ASSERT_EQ(end, text.data() + text.find(';'));
+    ASSERT_EQ(value, Money("-12345678901234567890"));
+    ASSERT_EQ(value.GetLength(), 23);
+
+    ASSERT_EQ(from_chars(std::string_view("+42"), value).ec, std::errc());
+    ASSERT_EQ(value, Money("42"));
+
+    // при ошибке значение не меняется
+    for (std::string_view bad : {"", "-", "+", "--1", "+-1", "a12", " 1", "-x"}) {
+        auto result = from_chars(bad, value);
+        ASSERT_EQ(result.ec, std::errc::invalid_argument) << bad;
+        ASSERT_EQ(result.ptr, bad.data()) << bad;
+        ASSERT_EQ(value, Money("42"));
+    }
+
+    // первая нецифра в любой позиции длинной строки, SIMD и скаляр совпадают
+    std::mt19937 gen(24);
+    std::uniform_int_distribution<int> digit('0', '9');
+    for (size_t length : {1u, 15u, 16u, 17u, 31u, 32u, 33u, 100u}) {
+        std::string digits(length, '0');
+        for (char& c : digits) {
+            c = static_cast<char>(digit(gen));
+        }
+        for (size_t bad = 0; bad <= length; ++bad) {
+            for (char c : {'/', ':', '-', '\x80', '\0'}) {
+                std::string line = digits;
+                if (bad < length) {
+                    line[bad] = c;
+                }
+                const char* first = line.data();
+                const char* last = first + line.size();
+                for (LimbIsa isa : {LimbIsa::Scalar, LimbIsa::Avx2}) {
+                    if (limb_isa_supported(isa)) {
+                        ASSERT_EQ(find_non_digit(isa, first, last) - first, static_cast<ptrdiff_t>(bad));
+                    }
+                }
+                ASSERT_EQ(find_non_digit(first, last) - first, static_cast<ptrdiff_t>(bad));
+            }
+        }
+        Money parsed;
+        ASSERT_EQ(from_chars(digits, parsed).ptr, digits.data() + digits.size());
+        std::stringstream ss;
+        ss << parsed;
+        ASSERT_EQ(ss.str(), digits);
+    }
+}
+
+namespace {
+
+// пишет в массив фиксированного размера, дальше отказывает
+class ShortBuffer : public std::streambuf {
+public:
+    ShortBuffer(char* first, size_t size) {
+        setp(first, first + size);
+    }
+};
+
+}
+
+TEST_F(MoneyTest, TestToChars) {
+    char buffer[64];
+    auto text = [&](const Money& m, char separator = 0) {
+        auto [end, ec] = separator ? to_chars(buffer, buffer + sizeof(buffer), m, separator) : to_chars(buffer, buffer + sizeof(buffer), m);
+        EXPECT_EQ(ec, std::errc());
+        return std::string(buffer, end);
+    };
+    ASSERT_EQ(text(Money("-1000000000000000000001")), "-1000000000000000000001");
+    ASSERT_EQ(text(Money("007")), "007");
+    ASSERT_EQ(text(Money()), "");
+    ASSERT_EQ(text(Money("-1234567"), ','), "-1,234,567");
+    ASSERT_EQ(text(Money("123456"), ' '), "123 456");
+    ASSERT_EQ(text(Money("12"), ','), "12");
+    ASSERT_EQ(text(Money("0001234"), '\''), "0'001'234");
+
+    // не помещается — value_too_large
+    Money m("-123456");
+    auto [end, ec] = to_chars(buffer, buffer + 6, m);
+    ASSERT_EQ(ec, std::errc::value_too_large);
+    ASSERT_EQ(end, buffer + 6);
+    ASSERT_EQ(to_chars(buffer, buffer + 7, m, ',').ec, std::errc::value_too_large);
+    ASSERT_EQ(to_chars(buffer, buffer + 7, m, ',').ptr, buffer + 7);
+
+    // длинные числа проходят через поток без потерь
+    std::mt19937 gen(25);
+    std::uniform_int_distribution<int> digit('0', '9');
+    for (size_t length : {1u, 9u, 10u, 127u, 128u, 129u, 1000u}) {
+        std::string digits(length, '0');
+        for (char& c : digits) {
+            c = static_cast<char>(digit(gen));
+        }
+        digits.insert(digits.begin(), '-');
+        std::stringstream ss;
+        ss << Money(digits);
+        ASSERT_EQ(ss.str(), digits);
+    }
+
+    // setw выравнивает всё число и сбрасывается, как для встроенных чисел
+    std::stringstream ss;
+    ss << std::setw(6) << Money("-42") << '|' << 7;
+    ASSERT_EQ(ss.str(), "   -42|7");
+    ss.str("");
+    ss << std::left << std::setfill('*') << std::setw(6) << Money("007") << 7;
+    ASSERT_EQ(ss.str(), "007***7");
+    ss.str("");
+    ss << std::internal << std::setfill('0') << std::setw(6) << Money("-42");
+    ASSERT_EQ(ss.str(), "-00042");
+    ss.str("");
+    ss << std::right << std::setw(2) << Money("12345");
+    ASSERT_EQ(ss.str(), "12345");
+
+    // в испорченный поток ничего не пишется, как и для встроенных чисел
+    std::stringstream failed;
+    failed.setstate(std::ios_base::failbit);
+    failed << std::setw(8) << Money("-42") << 5;
+    ASSERT_EQ(failed.str(), "");
+
+    // короткая запись выставляет badbit
+    char room[4];
+    ShortBuffer short_buffer(room, sizeof(room));
+    std::ostream out(&short_buffer);
+    out << Money("123456");
+    ASSERT_TRUE(out.bad());
+    out.clear();
+    ShortBuffer padded_buffer(room, sizeof(room));
+    out.rdbuf(&padded_buffer);
+    out << std::setw(6) << Money("1");
+    ASSERT_TRUE(out.bad());
+}
+
+TEST_F(MoneyTest, TestInlineAndHeapStorage) {
+    Money small("123456789012345678901234567");           // 27 цифр, встроенный буфер
+    Money large("1234567890123456789012345678901234567");  // 37 цифр, куча
+
+    Money a = small;
+    Money b = large;
+    std::swap(a, b);
+    ASSERT_EQ(a, large);
+    ASSERT_EQ(b, small);
+
+    Money moved_small = std::move(b);
+    Money moved_large = std::move(a);
+    ASSERT_EQ(moved_small, small);
+    ASSERT_EQ(moved_large, large);
+
+    // присваивание в обе стороны между режимами
+    moved_small = large;
+    moved_large = small;
+    ASSERT_EQ(moved_small, large);
+    ASSERT_EQ(moved_large, small);
+    moved_small = std::move(moved_large);
+    ASSERT_EQ(moved_small, small);
+
+    // рост из встроенного буфера в кучу при переносе
+    ASSERT_EQ(Money("999999999999999999999999999999999999") + Money("1"), Money("1000000000000000000000000000000000000"));
+}
+
+TEST_F(MoneyTest, TestCompoundAssignment) {
+    Money sum("0");
+    for (int i = 0; i < 1000; ++i) {
+        sum += Money("999999999");
+    }
+    ASSERT_EQ(sum, Money("999999999000"));
+
+    sum -= Money("999999999001");
+    ASSERT_EQ(sum, Money("-1"));
+    sum -= Money("-1");
+    ASSERT_EQ(sum, Money("0"));
+    std::stringstream ss;
+    ss << sum;
+    ASSERT_EQ(ss.str(), "0");
+
+    // короткое число плюс длинное и перенос через все limb'ы
+    Money value("1");
+    value += Money("999999999999999999999999999999999999999999999");
+    ASSERT_EQ(value, Money("1000000000000000000000000000000000000000000000"));
+
+    // операнд совпадает с *this
+    Money self("600000000000000000000000000000000000000");
+    self += self;
+    ASSERT_EQ(self, Money("1200000000000000000000000000000000000000"));
+    self -= self;
+    ASSERT_EQ(self, Money("0"));
+
+    Money negative("-5");
+    negative -= Money("3");
+    ASSERT_EQ(negative, Money("-8"));
+    negative += Money("10");
+    ASSERT_EQ(negative, Money("2"));
+}
+
+TEST_F(MoneyTest, TestThreeWayComparison) {
+    // больше 10 цифр: раньше сравнение шло через int32_t
+    Money big("98765432109876543210");
+    Money bigger("98765432109876543211");
+    ASSERT_TRUE(big < bigger);
+    ASSERT_TRUE((big <=> bigger) == std::weak_ordering::less);
+    ASSERT_TRUE((bigger <=> big) == std::weak_ordering::greater);
+    ASSERT_TRUE(Money("-98765432109876543211") < Money("-98765432109876543210"));
+    ASSERT_TRUE(Money("-1") < Money("0"));
+    ASSERT_TRUE(Money("-1000000000") < Money("-999999999"));
+
+    // равные по значению числа различимы при печати, поэтому порядок слабый
+    static_assert(std::is_same_v<decltype(Money() <=> Money()), std::weak_ordering>);
+    ASSERT_TRUE((Money("0007") <=> Money("7")) == std::weak_ordering::equivalent);
+    ASSERT_TRUE((Money("-0") <=> Money("000")) == std::weak_ordering::equivalent);
+    ASSERT_TRUE(Money("-0") <= Money("0"));
+    ASSERT_FALSE(Money("-0") < Money("0"));
+    ASSERT_TRUE(Money("-0") != Money("1"));
+
+    std::vector<Money> values = {Money("10000000000"), Money("-3"), Money("0"), Money("999999999"), Money("-10000000000")};
+    std::sort(values.begin(), values.end());
+    ASSERT_EQ(values[0], Money("-10000000000"));
+    ASSERT_EQ(values[1], Money("-3"));
+    ASSERT_EQ(values[2], Money("0"));
+    ASSERT_EQ(values[3], Money("999999999"));
+    ASSERT_EQ(values[4], Money("10000000000"));
+}
+
+TEST_F(MoneyTest, TestMultiplication) {
+    ASSERT_EQ(Money("123456789123") * Money("-1000"), Money("-123456789123000"));
+    ASSERT_EQ(Money("-0") * Money("5"), Money("0"));
+    ASSERT_EQ(Money("999999999") * 999999999, Money("999999998000000001"));
+    ASSERT_EQ(-3 * Money("-40"), Money("120"));
+    ASSERT_EQ(Money("2") * INT64_MIN, Money("-18446744073709551616"));
+    ASSERT_EQ(Money("1") * INT64_MAX, Money("9223372036854775807"));
+
+    Money value("12");
+    value *= value;
+    value *= 1000000000;
+    ASSERT_EQ(value, Money("144000000000"));
+    ASSERT_EQ(value.GetLength(), 12);
+
+    // (10^n - 1)^2 = 9...980...01
+    for (size_t n : {5, 100, 2000, 30000}) {
+        Money nines(n, '9');
+        std::string expected = std::string(n - 1, '9') + "8" + std::string(n - 1, '0') + "1";
+        ASSERT_EQ(nines * nines, Money(expected));
+    }
+}
+
+TEST_F(MoneyTest, TestMultiplicationAlgorithmsAgree) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<uint32_t> limb(0, 999999999);
+    // размеры по обе стороны порогов и сильно разные по длине множители
+    std::vector<std::pair<size_t, size_t>> sizes = {{1, 1}, {3, 7}, {40, 40}, {81, 57}, {150, 151}, {400, 17}, {1500, 1499}, {2000, 3001}};
+    for (auto [an, bn] : sizes) {
+        std::vector<uint32_t> a(an), b(bn);
+        for (auto& x : a) x = limb(gen);
+        for (auto& x : b) x = limb(gen);
+        // все limb'ы максимальные: самые большие переносы
+        if (an == bn + 1) {
+            std::fill(a.begin(), a.end(), 999999999);
+            std::fill(b.begin(), b.end(), 999999999);
+        }
+        a.back() = std::max<uint32_t>(a.back(), 1);
+        b.back() = std::max<uint32_t>(b.back(), 1);
+
+        std::vector<uint32_t> expected(an + bn);
+        size_t expected_size = mul_limbs(MulAlgorithm::Schoolbook, a.data(), an, b.data(), bn, expected.data());
+        for (MulAlgorithm algorithm : {MulAlgorithm::Karatsuba, MulAlgorithm::Toom3, MulAlgorithm::Ntt}) {
+            std::vector<uint32_t> r(an + bn);
+            size_t size = mul_limbs(algorithm, a.data(), an, b.data(), bn, r.data());
+            ASSERT_EQ(size, expected_size);
+            ASSERT_EQ(r, expected);
+        }
+        std::vector<uint32_t> r(an + bn);
+        ASSERT_EQ(mul_limbs(a.data(), an, b.data(), bn, r.data()), expected_size);
+        ASSERT_EQ(r, expected);
+    }
+}
+
+TEST_F(MoneyTest, TestDivisionByInteger) {
+    ASSERT_EQ(Money("1000000000000000000000") / 7, Money("142857142857142857142"));
+    ASSERT_EQ(Money("1000000000000000000000") % 7, Money("6"));
+    ASSERT_EQ(Money("-17") / 5, Money("-3"));
+    ASSERT_EQ(Money("-17") % 5, Money("-2"));
+    ASSERT_EQ(Money("17") / -5, Money("-3"));
+    ASSERT_EQ(Money("17") % -5, Money("2"));
+    ASSERT_EQ(Money("99999999999999999999") % 4294967295, Money("3470220849"));
+    ASSERT_EQ(Money("18446744073709551616") / INT64_MIN, Money("-2"));
+    ASSERT_EQ(Money("3") / 10, Money("0"));
+
+    Money value("123456789012345678901234567890");
+    value /= 1000000000;
+    ASSERT_EQ(value, Money("123456789012345678901"));
+    value %= 1000;
+    ASSERT_EQ(value, Money("901"));
+
+    ASSERT_THROW(Money("5") / 0, std::invalid_argument);
+    ASSERT_THROW(Money("5") % Money("-0"), std::invalid_argument);
+}
+
+TEST_F(MoneyTest, TestDivisionByMoney) {
+    Money a("123456789012345678901234567890123456789");
+    Money b("-987654321987654321");
+    Money q = a / b;
+    Money r = a % b;
+    ASSERT_EQ(q, Money("-124999998748437501153"));
+    ASSERT_EQ(q * b + r, a);
+    ASSERT_TRUE(r >= Money("0"));
+    ASSERT_TRUE(r < Money("987654321987654321"));
+    ASSERT_EQ(Money("5") / Money("123456789012"), Money("0"));
+    ASSERT_EQ(Money("-5") % Money("123456789012"), Money("-5"));
+
+    a /= a;
+    ASSERT_EQ(a, Money("1"));
+}
+
+TEST_F(MoneyTest, TestDivisionAlgorithmsAgree) {
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<uint32_t> limb(0, 999999999);
+    // делитель с маленьким и с большим старшим limb'ом, длинное частное
+    std::vector<std::pair<size_t, size_t>> sizes = {{2, 2}, {5, 3}, {40, 17}, {300, 150}, {1000, 37}, {700, 400}};
+    for (auto [an, bn] : sizes) {
+        for (uint32_t top : {1u, 999999999u}) {
+            std::vector<uint32_t> a(an), b(bn);
+            for (auto& x : a) x = limb(gen);
+            for (auto& x : b) x = limb(gen);
+            a.back() = std::max<uint32_t>(a.back(), 1);
+            b.back() = top;
+
+            std::vector<uint32_t> q1(an - bn + 1), r1(bn), q2(an - bn + 1), r2(bn);
+            divmod_limbs(DivAlgorithm::Long, a.data(), an, b.data(), bn, q1.data(), r1.data());
+            divmod_limbs(DivAlgorithm::Newton, a.data(), an, b.data(), bn, q2.data(), r2.data());
+            ASSERT_EQ(q1, q2);
+            ASSERT_EQ(r1, r2);
+
+            // a == q * b + r и r < b
+            std::vector<uint32_t> check(an + 1);
+            mul_limbs(q1.data(), q1.size(), b.data(), bn, check.data());
+            size_t rn = normalize_limbs(r1.data(), bn);
+            ASSERT_LT(compare_limbs(r1.data(), rn, b.data(), bn), 0);
+            size_t cn = add_limbs(check.data(), normalize_limbs(check.data(), an), r1.data(), rn, check.data());
+            ASSERT_EQ(compare_limbs(check.data(), cn, a.data(), an), 0);
+        }
+    }
+}
+
+TEST_F(MoneyTest, TestAllocate) {
+    std::vector<Money> shares = Money("100").allocate(3);
+    ASSERT_EQ(shares.size(), 3);
+    ASSERT_EQ(shares[0], Money("34"));
+    ASSERT_EQ(shares[1], Money("33"));
+    ASSERT_EQ(shares[2], Money("33"));
+
+    shares = Money("-2").allocate(3);
+    ASSERT_EQ(shares[0], Money("-1"));
+    ASSERT_EQ(shares[1], Money("-1"));
+    ASSERT_EQ(shares[2], Money("0"));
+
+    Money total("1000000000000000000000000000001");
+    Money sum("0");
+    for (const Money& share : total.allocate(7)) {
+        sum += share;
+    }
+    ASSERT_EQ(sum, total);
+
+    ASSERT_THROW(total.allocate(0), std::invalid_argument);
+}
+
+TEST_F(MoneyTest, TestSimdAddSubMatchScalar) {
+    std::mt19937 gen(3);
+    // много limb'ов 999999999 и равных пар: переносы бегут через весь блок
+    std::vector<uint32_t> pool = {0, 1, 499999999, 500000000, 999999998, 999999999};
+    std::uniform_int_distribution<size_t> pick(0, pool.size() - 1);
+    std::uniform_int_distribution<uint32_t> limb(0, 999999999);
+    for (LimbIsa isa : {LimbIsa::Avx2}) {
+        if (!limb_isa_supported(isa)) {
+            continue;
+        }
+        for (size_t n : {1, 7, 8, 9, 16, 31, 64, 1000}) {
+            for (int round = 0; round < 50; ++round) {
+                std::vector<uint32_t> a(n), b(n);
+                for (size_t i = 0; i < n; ++i) {
+                    a[i] = round % 2 ? pool[pick(gen)] : limb(gen);
+                    b[i] = round % 3 ? pool[pick(gen)] : a[i];
+                }
+                std::vector<uint32_t> expected(n), actual(n);
+                ASSERT_EQ(add_n(LimbIsa::Scalar, a.data(), b.data(), n, expected.data()),
+                          add_n(isa, a.data(), b.data(), n, actual.data()));
+                ASSERT_EQ(actual, expected);
+                ASSERT_EQ(sub_n(LimbIsa::Scalar, a.data(), b.data(), n, expected.data()),
+                          sub_n(isa, a.data(), b.data(), n, actual.data()));
+                ASSERT_EQ(actual, expected);
+            }
+        }
+    }
+}
+
+TEST_F(MoneyTest, TestAccumulator) {
+    std::vector<Money> ledger;
+    Money expected("0");
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> length(1, 60);
+    std::uniform_int_distribution<int> digit(0, 9);
+    for (int i = 0; i < 2000; ++i) {
+        std::string text = i % 3 == 0 ? "-" : "";
+        int n = length(gen);
+        for (int j = 0; j < n; ++j) {
+            text.push_back(static_cast<char>('0' + digit(gen)));
+        }
+        ledger.emplace_back(text);
+        expected += ledger.back();
+    }
+
+    MoneyAccumulator accumulator;
+    accumulator.add(std::span<const Money>(ledger));
+    ASSERT_EQ(accumulator.total(), expected);
+
+    // диапазон итераторов и слияние двух половин
+    MoneyAccumulator first;
+    MoneyAccumulator second;
+    first.add(ledger.begin(), ledger.begin() + 1000);
+    second.add(ledger.begin() + 1000, ledger.end());
+    first.merge(second);
+    ASSERT_EQ(first.total(), expected);
+
+    // перенос через все lane'ы
+    MoneyAccumulator nines;
+    for (int i = 0; i < 1000; ++i) {
+        nines.add(Money(45, '9'));
+    }
+    ASSERT_EQ(nines.total(), Money(45, '9') * 1000);
+
+    // маленький лимит: переносы выполняются посреди span'а и при слиянии
+    for (uint64_t limit : {1, 2, 7, 1000}) {
+        MoneyAccumulator small(limit);
+        small.add(std::span<const Money>(ledger));
+        ASSERT_EQ(small.total(), expected);
+
+        MoneyAccumulator one_by_one(limit);
+        one_by_one.add(ledger.begin(), ledger.begin() + 1000);
+        MoneyAccumulator rest(limit);
+        rest.add(std::span<const Money>(ledger).subspan(1000));
+        one_by_one.merge(rest);
+        ASSERT_EQ(one_by_one.total(), expected);
+
+        MoneyAccumulator small_nines(limit);
+        std::vector<Money> many(1000, Money(45, '9'));
+        small_nines.add(std::span<const Money>(many));
+        ASSERT_EQ(small_nines.total(), Money(45, '9') * 1000);
+    }
+
+    nines.add(Money("-0"));
+    nines.reset();
+    ASSERT_EQ(nines.total(), Money("0"));
+    nines.add(Money("-5")).add(Money("3"));
+    ASSERT_EQ(nines.total(), Money("-2"));
+}
+
+TEST_F(MoneyTest, TestParallelSum) {
+    // несколько чанков на поток даже при маленьком MIN_CHUNK
+    std::vector<Money> ledger;
+    Money expected("0");
+    for (int i = 0; i < 100000; ++i) {
+        ledger.push_back(Money(std::to_string(i % 7 == 0 ? -i * 1000003LL : i * 999999937LL)));
+        expected += ledger.back();
+    }
+    for (unsigned threads : {1u, 2u, 3u, 8u}) {
+        std::vector<ReduceThreadStats> stats;
+        ASSERT_EQ(parallel_sum(ledger, threads, &stats), expected);
+        ASSERT_FALSE(stats.empty());
+        ASSERT_LE(stats.size(), threads);
+        size_t items = 0;
+        for (const ReduceThreadStats& thread : stats) {
+            items += thread.items;
+        }
+        ASSERT_EQ(items, ledger.size());
+    }
+
+    Money doubled = parallel_transform_reduce(std::span<const Money>(ledger), [](const Money& m) { return m * 2; }, 4);
+    ASSERT_EQ(doubled, expected * 2);
+
+    std::vector<int64_t> cents = {1, -2, 3};
+    ASSERT_EQ(parallel_transform_reduce(std::span<const int64_t>(cents), [](int64_t c) { return Money(std::to_string(c)); }), Money("2"));
+    // вектор передаётся без явного span
+    ASSERT_EQ(parallel_transform_reduce(cents, [](int64_t c) { return Money(std::to_string(c)); }), Money("2"));
+    ASSERT_EQ(parallel_sum({}), Money("0"));
+
+    // исключение из потока не роняет процесс и не вешает барьер
+    for (unsigned threads : {1u, 3u, 8u}) {
+        for (size_t bad : {size_t{0}, ledger.size() - 1}) {
+            auto transform = [&](const Money& m) {
+                if (&m == &ledger[bad]) {
+                    throw std::invalid_argument("bad entry");
+                }
+                return m;
+            };
+            ASSERT_THROW(parallel_transform_reduce(ledger, transform, threads), std::invalid_argument);
+        }
+    }
+}
+
+namespace {
+
+// считает блоки, взятые у new/delete; после fail_after блоков бросает bad_alloc
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocated = 0;
+    size_t live = 0;
+    size_t fail_after = SIZE_MAX;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (allocated == fail_after) {
+            throw std::bad_alloc();
+        }
+        ++allocated;
+        ++live;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        --live;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+}
+
+TEST_F(MoneyTest, TestMemoryResource) {
+    ASSERT_EQ(Money().get_resource(), std::pmr::get_default_resource());
+
+    std::string big(100, '7');
+    CountingResource counting;
+    {
+        Money a(big, &counting);
+        ASSERT_EQ(a.get_resource(), &counting);
+        ASSERT_EQ(counting.allocated, 1u);
+
+        // копия берёт ресурс по умолчанию, перемещение — ресурс источника
+        Money copy = a;
+        ASSERT_EQ(copy.get_resource(), std::pmr::get_default_resource());
+        Money moved = std::move(copy);
+        ASSERT_EQ(moved.get_resource(), std::pmr::get_default_resource());
+
+        // присваивание и операции на месте не меняют ресурс
+        a = moved * moved;
+        ASSERT_EQ(a.get_resource(), &counting);
+        ASSERT_EQ(a, moved * moved);
+        a *= a;
+        a /= moved;
+        a %= Money(big);
+        ASSERT_EQ(a.get_resource(), &counting);
+        ASSERT_EQ(a, (moved * moved * moved * moved / moved) % Money(big));
+
+        Money small(&counting);
+        small += Money("12");
+        ASSERT_EQ(small, Money("12"));
+        Money tmp(big);
+        small = std::move(tmp);
+        ASSERT_EQ(small.get_resource(), &counting);
+        ASSERT_EQ(small, Money(big));
+
+        // если памяти не хватило, копирующее присваивание ничего не меняет
+        Money target("-5", &counting);
+        Money source(big + big);
+        counting.fail_after = counting.allocated;
+        ASSERT_THROW(target = source, std::bad_alloc);
+        counting.fail_after = SIZE_MAX;
+        ASSERT_EQ(target, Money("-5"));
+        ASSERT_EQ(target.GetLength(), 2u);
+    }
+    ASSERT_EQ(counting.live, 0u);
+
+    // временные значения целиком уходят в арену
+    CountingResource upstream;
+    {
+        std::pmr::monotonic_buffer_resource arena(&upstream);
+        std::pmr::memory_resource* previous = std::pmr::set_default_resource(&arena);
+        Money total("0");
+        for (int i = 0; i < 100; ++i) {
+            total += Money(big) * Money(big);
+        }
+        std::pmr::set_default_resource(previous);
+        ASSERT_EQ(total, Money(big) * Money(big) * 100);
+        ASSERT_GT(upstream.allocated, 0u);
+    }
+    ASSERT_EQ(upstream.live, 0u);
+}